@@ -0,0 +1,89 @@
+/**
+ * Bint multiplication from 10 to 10^6 decimal digits.
+ * usage: bint_bench [max digits]
+ * for each size: reading both factors from decimal, one product through Bint, the same product schoolbook on the
+ * raw limbs (up to 10^5 digits), and printing the product in decimal.
+ * (10^d - 1)^2 = 9..980..01 is checked at every size.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "class-bint.hpp"
+
+namespace {
+
+template<class F>
+double timed(F f) // ms for one call, repeated for at least 100 ms.
+{
+	int reps = 0;
+	const auto start = std::chrono::steady_clock::now();
+	double ms;
+	do {
+		f(), ++reps;
+		ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	} while (ms < 100);
+	return ms / reps;
+}
+
+unsigned long long seed = 2333;
+
+unsigned long long next()
+{
+	seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+	return seed;
+}
+
+std::string digits(size_t d)
+{
+	std::string s(d, '0');
+	for (size_t i = 0; i < d; ++i) {
+		s[i] = char('0' + next() % 10);
+	}
+	s[0] = char('1' + next() % 9);
+	return s;
+}
+
+std::string str(const Util::Bint &x)
+{
+	std::ostringstream os;
+	os << x;
+	return os.str();
+}
+
+bool check(size_t d) // (10^d - 1)^2 = 9^(d - 1) 8 0^(d - 1) 1.
+{
+	const Util::Bint x(std::string(d, '9'));
+	return str(x * x) == std::string(d - 1, '9') + "8" + std::string(d - 1, '0') + "1";
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	const size_t maxDigits = argc > 1 ? atol(argv[1]) : 1000000;
+	printf("%10s %8s %12s %12s %14s %12s %6s\n", "digits", "limbs", "read ms", "mul ms", "schoolbook ms", "print ms", "check");
+	for (size_t d = 10; d <= maxDigits; d *= 10) {
+		const std::string sa = digits(d), sb = digits(d);
+		Util::Bint a, b, p;
+		const double read = timed([&] { a = Util::Bint(sa), b = Util::Bint(sb); }) / 2;
+		const double mul = timed([&] { p = a * b; });
+		const size_t n = size_t(d * 0.1038102529 + 1); // log(10) / log(2^32) limbs a digit.
+		char school[32] = "-";
+		if (d <= 100000) { // random limbs of the same count, r = a * b the quadratic way.
+			std::vector<Util::Limbs::limb> x(n), y(n), r(2 * n);
+			for (size_t i = 0; i < n; ++i) {
+				x[i] = Util::Limbs::limb(next()), y[i] = Util::Limbs::limb(next());
+			}
+			snprintf(school, sizeof(school), "%.4f", timed([&] {
+				Util::Limbs::mulBasecase<Util::Limbs::BINARY>(r.data(), x.data(), n, y.data(), n);
+			}));
+		}
+		std::string out;
+		const double print = timed([&] { out = str(p); });
+		printf("%10zu %8zu %12.4f %12.4f %14s %12.4f %6s\n", d, n, read, mul, school, print, check(d) ? "ok" : "WRONG");
+	}
+	return 0;
+}
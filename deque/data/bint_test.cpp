@@ -0,0 +1,197 @@
+/**
+ * Bint against schoolbook arithmetic on decimal strings: +, -, *, the comparisons, printing and reading back.
+ * usage: bint_test [operations] [max digits]
+ * the sizes reach past the Karatsuba and Toom-3 thresholds, and one factor is sometimes much shorter than the other.
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "class-bint.hpp"
+
+namespace {
+
+int failures = 0;
+#define EXPECT(cond) do { if (!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while (0)
+
+unsigned long long seed = 2333;
+
+unsigned long long next()
+{
+	seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+	return seed;
+}
+
+struct Dec { // the reference: a sign and the decimal digits, most significant first, no leading zeros.
+	bool minus;
+	std::string abs;
+	std::string str() const { return minus ? "-" + abs : abs; }
+};
+
+Dec dec(bool minus, std::string abs)
+{
+	const size_t nz = abs.find_first_not_of('0');
+	abs = nz == std::string::npos ? "0" : abs.substr(nz);
+	return Dec{minus && abs != "0", abs};
+}
+
+int cmpAbs(const std::string &a, const std::string &b)
+{
+	if (a.size() != b.size()) {
+		return a.size() < b.size() ? -1 : 1;
+	}
+	return a.compare(b) < 0 ? -1 : a.compare(b) > 0;
+}
+
+int cmp(const Dec &a, const Dec &b)
+{
+	if (a.minus != b.minus) {
+		return a.minus ? -1 : 1;
+	}
+	return a.minus ? -cmpAbs(a.abs, b.abs) : cmpAbs(a.abs, b.abs);
+}
+
+std::string addAbs(const std::string &a, const std::string &b)
+{
+	std::string r;
+	int carry = 0;
+	for (size_t i = 0; i < a.size() || i < b.size() || carry; ++i) {
+		const int s = carry + (i < a.size() ? a[a.size() - 1 - i] - '0' : 0) + (i < b.size() ? b[b.size() - 1 - i] - '0' : 0);
+		r.push_back(char('0' + s % 10)), carry = s / 10;
+	}
+	return std::string(r.rbegin(), r.rend());
+}
+
+std::string subAbs(const std::string &a, const std::string &b) // a >= b.
+{
+	std::string r;
+	int borrow = 0;
+	for (size_t i = 0; i < a.size(); ++i) {
+		int s = a[a.size() - 1 - i] - '0' - borrow - (i < b.size() ? b[b.size() - 1 - i] - '0' : 0);
+		borrow = s < 0, s += borrow * 10;
+		r.push_back(char('0' + s));
+	}
+	return std::string(r.rbegin(), r.rend());
+}
+
+std::string mulAbs(const std::string &a, const std::string &b)
+{
+	std::vector<unsigned long long> r(a.size() + b.size());
+	for (size_t i = 0; i < a.size(); ++i) {
+		for (size_t j = 0; j < b.size(); ++j) {
+			r[i + j + 1] += (a[i] - '0') * (b[j] - '0');
+		}
+		if (i % 1024 == 1023) { // push the carries up now and then, so the columns stay small.
+			for (size_t k = r.size() - 1; k; --k) {
+				r[k - 1] += r[k] / 10, r[k] %= 10;
+			}
+		}
+	}
+	for (size_t k = r.size() - 1; k; --k) {
+		r[k - 1] += r[k] / 10, r[k] %= 10;
+	}
+	std::string s(r.size(), '0');
+	for (size_t k = 0; k < r.size(); ++k) {
+		s[k] = char('0' + r[k]);
+	}
+	return s;
+}
+
+Dec add(const Dec &a, const Dec &b)
+{
+	if (a.minus == b.minus) {
+		return dec(a.minus, addAbs(a.abs, b.abs));
+	}
+	return cmpAbs(a.abs, b.abs) >= 0 ? dec(a.minus, subAbs(a.abs, b.abs)) : dec(b.minus, subAbs(b.abs, a.abs));
+}
+
+Dec neg(const Dec &a)
+{
+	return dec(!a.minus, a.abs);
+}
+
+Dec mul(const Dec &a, const Dec &b)
+{
+	return dec(a.minus != b.minus, mulAbs(a.abs, b.abs));
+}
+
+std::string str(const Util::Bint &x)
+{
+	std::ostringstream os;
+	os << x;
+	return os.str();
+}
+
+Dec random(size_t maxDigits)
+{
+	const size_t shape = next() % 8;
+	size_t d = shape < 4 ? 1 + next() % 40 : 1 + next() % maxDigits;
+	std::string s(d, '0');
+	for (size_t i = 0; i < d; ++i) {
+		s[i] = char('0' + next() % 10);
+	}
+	if (shape == 7) { // 99..9 and 100..0, the carries run the whole length.
+		s = next() & 1 ? std::string(d, '9') : "1" + std::string(d - 1, '0');
+	}
+	return dec(next() & 1, s);
+}
+
+void fuzz(long n, size_t maxDigits)
+{
+	for (long step = 0; step < n; ++step) {
+		const Dec a = random(maxDigits), b = next() % 4 ? random(maxDigits) : (next() & 1 ? a : neg(a));
+		const Util::Bint x(a.str()), y(b.str());
+		EXPECT(str(x) == a.str() && str(y) == b.str());
+		EXPECT(str(x + y) == add(a, b).str());
+		EXPECT(str(x - y) == add(a, neg(b)).str());
+		EXPECT(str(-x) == neg(a).str() && str(abs(x)) == a.abs);
+		EXPECT(str(x * y) == mul(a, b).str());
+		const int c = cmp(a, b);
+		EXPECT((x == y) == (c == 0) && (x != y) == (c != 0));
+		EXPECT((x < y) == (c < 0) && (x > y) == (c > 0) && (x <= y) == (c <= 0) && (x >= y) == (c >= 0));
+		if (failures) {
+			return;
+		}
+	}
+}
+
+void small() // the int and long long paths, zero and its sign.
+{
+	long step = 0;
+	for (; step < 2000; ++step) {
+		const long long a = (long long)next() >> (next() % 64), b = step % 2 ? -(long long)(next() >> 34) : (long long)(next() >> 34);
+		Util::Bint x(a), y;
+		y = b;
+		EXPECT(str(x) == std::to_string(a) && str(y) == std::to_string(b));
+		EXPECT(str(x + y) == add(dec(a < 0, std::to_string(a < 0 ? -(unsigned long long)a : a)), dec(b < 0, std::to_string(b < 0 ? -b : b))).str());
+		EXPECT((x < y) == (a < b) && (x == y) == (a == b));
+		y = int(b % 1000);
+		EXPECT(str(y) == std::to_string(int(b % 1000)));
+	}
+	const Util::Bint zero(0), minusZero("-0"), five(5);
+	EXPECT(zero == minusZero && !(minusZero < zero) && str(-zero) == "0" && str(minusZero) == "0");
+	EXPECT(str(five - five) == "0" && str(-five + five) == "0" && str(-five * zero) == "0");
+	Util::Bint moved(std::string(5000, '7')), target(1);
+	target = std::move(moved);
+	EXPECT(str(target) == std::string(5000, '7'));
+	std::istringstream is("-123456789012345678901234567890");
+	is >> target;
+	EXPECT(str(target) == "-123456789012345678901234567890");
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	const long n = argc > 1 ? atol(argv[1]) : 200;
+	const size_t maxDigits = argc > 2 ? atol(argv[2]) : 6000;
+	small();
+	fuzz(n, maxDigits);
+	if (failures) {
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
@@ -19,11 +19,12 @@ class Bint {
 		BadCast();
 	};
 	bool isMinus = false;
-	size_t length;
-	int *data = nullptr;
+	size_t length; // limbs in base 2^32, least significant first; zero is one 0 limb and never minus.
+	unsigned int *data = nullptr;
 	size_t capacity = MIN_CAPACITY;
 	void _DoubleSpace();
-	void _SafeNewSpace(int *&p, const size_t &len);
+	void _SafeNewSpace(unsigned int *&p, const size_t &len);
+	void _Normalize();
 	explicit Bint(const size_t &capa);
 public:
 	Bint();
@@ -66,16 +67,353 @@ public:
 
 namespace Util {
 
+/*
+ * the arithmetic behind Bint, on arrays of limbs in base B, least significant first.
+ * Bint itself is in base 2^32, base 10^9 is only used to read and print decimal.
+ * a product of two limbs plus two more limbs still fits in 64 bits for both bases.
+ * products are schoolbook for short factors, Karatsuba above KARATSUBA_THRESHOLD limbs and Toom-3 above
+ * TOOM3_THRESHOLD, both measured on random factors; bint_bench times the whole range.
+ */
+namespace Limbs {
+
+typedef unsigned int limb;
+typedef unsigned long long wide;
+
+const wide BINARY = 1ULL << 32;
+const wide DECIMAL = 1000000000;
+const size_t KARATSUBA_THRESHOLD = 32; // limbs of the shorter factor.
+const size_t TOOM3_THRESHOLD = 256;
+const size_t CONVERT_THRESHOLD = 32; // limbs converted digit by digit between bases.
+
+inline size_t trim(const limb *a, size_t n)
+{
+	while (n && a[n - 1] == 0) {
+		--n;
+	}
+	return n;
+}
+
+inline int compare(const limb *a, size_t na, const limb *b, size_t nb) // both trimmed.
+{
+	if (na != nb) {
+		return na < nb ? -1 : 1;
+	}
+	for (size_t i = na; i-- > 0; ) {
+		if (a[i] != b[i]) {
+			return a[i] < b[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+template<wide B>
+void add(limb *r, const limb *a, size_t na, const limb *b, size_t nb) // r[0, na] = a + b, na >= nb, r may be a.
+{
+	wide carry = 0;
+	for (size_t i = 0; i < nb; ++i) {
+		const wide t = a[i] + carry + b[i];
+		carry = t >= B;
+		r[i] = limb(carry ? t - B : t);
+	}
+	for (size_t i = nb; i < na; ++i) {
+		const wide t = a[i] + carry;
+		carry = t >= B;
+		r[i] = limb(carry ? t - B : t);
+	}
+	r[na] = limb(carry);
+}
+
+template<wide B>
+void sub(limb *r, const limb *a, size_t na, const limb *b, size_t nb) // r[0, na) = a - b, a >= b, r may be a.
+{
+	wide borrow = 0;
+	for (size_t i = 0; i < na; ++i) {
+		const wide s = (i < nb ? b[i] : 0) + borrow;
+		borrow = a[i] < s;
+		r[i] = limb(a[i] + (borrow ? B : 0) - s);
+	}
+}
+
+template<wide B>
+void addTo(limb *r, size_t nr, const limb *a, size_t na) // r[0, nr) += a, the sum must fit.
+{
+	wide carry = 0;
+	size_t i = 0;
+	for (; i < na; ++i) {
+		const wide t = r[i] + carry + a[i];
+		carry = t >= B;
+		r[i] = limb(carry ? t - B : t);
+	}
+	for (; carry && i < nr; ++i) {
+		const wide t = r[i] + carry;
+		carry = t >= B;
+		r[i] = limb(carry ? t - B : t);
+	}
+}
+
+template<wide B>
+void subFrom(limb *r, size_t nr, const limb *a, size_t na) // r[0, nr) -= a, r >= a.
+{
+	sub<B>(r, r, nr, a, na);
+}
+
+template<wide B>
+void mulBasecase(limb *r, const limb *a, size_t na, const limb *b, size_t nb) // r[0, na + nb) = a * b, nb > 0.
+{
+	const wide TERMS = (~0ULL - B) / ((B - 1) * (B - 1)); // products a 64-bit column takes on top of a limb.
+	if (TERMS < 2) { // base 2^32: one product fills 64 bits, the carry goes along the row.
+		std::fill(r, r + na + nb, 0);
+		for (size_t i = 0; i < na; ++i) {
+			const wide x = a[i];
+			limb *row = r + i;
+			wide carry = 0;
+			for (size_t j = 0; j < nb; ++j) {
+				const wide t = row[j] + carry + x * b[j];
+				row[j] = limb(t % B);
+				carry = t / B;
+			}
+			row[nb] = limb(carry);
+		}
+		return;
+	}
+	wide carry = 0; // base 10^9: column by column, a division every TERMS products only.
+	for (size_t k = 0; k + 1 < na + nb; ++k) {
+		wide acc = carry % B, high = carry / B;
+		size_t terms = 0;
+		for (size_t i = k < nb ? 0 : k - nb + 1, to = std::min(k + 1, na); i < to; ++i) {
+			acc += wide(a[i]) * b[k - i];
+			if (++terms == TERMS) {
+				high += acc / B, acc %= B, terms = 0;
+			}
+		}
+		r[k] = limb(acc % B);
+		carry = high + acc / B;
+	}
+	r[na + nb - 1] = limb(carry);
+}
+
+template<wide B>
+void mul(limb *r, const limb *a, size_t na, const limb *b, size_t nb);
+
+template<wide B>
+void mulUnbalanced(limb *r, const limb *a, size_t na, const limb *b, size_t nb) // na >= 2 nb: a in pieces of nb.
+{
+	std::fill(r, r + na + nb, 0);
+	std::vector<limb> t(2 * nb);
+	for (size_t i = 0; i < na; i += nb) {
+		const size_t n = std::min(nb, na - i);
+		mul<B>(t.data(), a + i, n, b, nb);
+		addTo<B>(r + i, na + nb - i, t.data(), trim(t.data(), n + nb));
+	}
+}
+
+template<wide B>
+void mulKaratsuba(limb *r, const limb *a, size_t na, const limb *b, size_t nb) // na / 2 < nb <= na.
+{
+	const size_t h = na / 2, ha = na - h, hb = nb - h; // a = a1 B^h + a0, a1 has ha limbs, b1 has hb.
+	mul<B>(r, a, h, b, h);
+	mul<B>(r + 2 * h, a + h, ha, b + h, hb);
+	std::vector<limb> sa(ha + 1), sb(std::max(h, hb) + 1), t(sa.size() + sb.size());
+	add<B>(sa.data(), a + h, ha, a, h);
+	if (hb >= h) {
+		add<B>(sb.data(), b + h, hb, b, h);
+	} else {
+		add<B>(sb.data(), b, h, b + h, hb);
+	}
+	mul<B>(t.data(), sa.data(), trim(sa.data(), sa.size()), sb.data(), trim(sb.data(), sb.size()));
+	size_t nt = trim(t.data(), t.size()); // (a0 + a1)(b0 + b1) - a0 b0 - a1 b1 = a0 b1 + a1 b0.
+	subFrom<B>(t.data(), nt, r, trim(r, 2 * h));
+	subFrom<B>(t.data(), nt, r + 2 * h, trim(r + 2 * h, ha + hb));
+	addTo<B>(r + h, na + nb - h, t.data(), trim(t.data(), nt));
+}
+
+struct Signed { // for the evaluation points of Toom-3, which may be negative.
+	std::vector<limb> d; // trimmed.
+	bool minus;
+	Signed(const limb *a, size_t n) : d(a, a + trim(a, n)), minus(false) {}
+	Signed(std::vector<limb> &&_d, bool _minus) : d(std::move(_d)), minus(_minus && !d.empty()) {}
+};
+
+template<wide B>
+Signed plus(const Signed &x, const Signed &y)
+{
+	const Signed &p = x.d.size() >= y.d.size() ? x : y, &q = &p == &x ? y : x;
+	if (x.minus == y.minus) {
+		std::vector<limb> r(p.d.size() + 1);
+		add<B>(r.data(), p.d.data(), p.d.size(), q.d.data(), q.d.size());
+		r.resize(trim(r.data(), r.size()));
+		return Signed(std::move(r), x.minus);
+	}
+	const bool swap = compare(x.d.data(), x.d.size(), y.d.data(), y.d.size()) < 0;
+	const Signed &big = swap ? y : x, &small = swap ? x : y;
+	std::vector<limb> r(big.d.size());
+	sub<B>(r.data(), big.d.data(), big.d.size(), small.d.data(), small.d.size());
+	r.resize(trim(r.data(), r.size()));
+	return Signed(std::move(r), big.minus);
+}
+
+template<wide B>
+Signed minus(const Signed &x, Signed y)
+{
+	y.minus = !y.minus && !y.d.empty();
+	return plus<B>(x, y);
+}
+
+template<wide B>
+Signed times(const Signed &x, const Signed &y)
+{
+	std::vector<limb> r(x.d.size() + y.d.size());
+	mul<B>(r.data(), x.d.data(), x.d.size(), y.d.data(), y.d.size());
+	r.resize(trim(r.data(), r.size()));
+	return Signed(std::move(r), x.minus != y.minus);
+}
+
+template<wide B, limb m>
+Signed scale(Signed x) // x * m, m small.
+{
+	wide carry = 0;
+	for (size_t i = 0; i < x.d.size(); ++i) {
+		const wide t = x.d[i] * wide(m) + carry;
+		x.d[i] = limb(t % B);
+		carry = t / B;
+	}
+	if (carry) {
+		x.d.push_back(limb(carry));
+	}
+	return x;
+}
+
+template<wide B, limb m>
+Signed divide(Signed x) // x / m, which must be exact.
+{
+	wide rem = 0;
+	for (size_t i = x.d.size(); i-- > 0; ) {
+		const wide t = rem * B + x.d[i];
+		x.d[i] = limb(t / m);
+		rem = t % m;
+	}
+	x.d.resize(trim(x.d.data(), x.d.size()));
+	return x;
+}
+
+template<wide B>
+void mulToom3(limb *r, const limb *a, size_t na, const limb *b, size_t nb) // 2 k < nb <= na, k = ceil(na / 3).
+{
+	const size_t k = (na + 2) / 3;
+	const Signed a0(a, k), a1(a + k, k), a2(a + 2 * k, na - 2 * k);
+	const Signed b0(b, k), b1(b + k, k), b2(b + 2 * k, nb - 2 * k);
+	// a and b at 0, 1, -1, -2 and infinity, with x = B^k.
+	Signed s = plus<B>(a0, a2), t = plus<B>(b0, b2);
+	const Signed p1 = plus<B>(s, a1), q1 = plus<B>(t, b1);
+	const Signed pm1 = minus<B>(s, a1), qm1 = minus<B>(t, b1);
+	const Signed pm2 = minus<B>(scale<B, 2>(plus<B>(pm1, a2)), a0);
+	const Signed qm2 = minus<B>(scale<B, 2>(plus<B>(qm1, b2)), b0);
+	const Signed r0 = times<B>(a0, b0), r4 = times<B>(a2, b2);
+	Signed r1 = times<B>(p1, q1), rm1 = times<B>(pm1, qm1), rm2 = times<B>(pm2, qm2);
+	// interpolation as in Bodrato and Zanoni, the divisions are exact.
+	Signed r3 = divide<B, 3>(minus<B>(rm2, r1));
+	r1 = divide<B, 2>(minus<B>(r1, rm1));
+	Signed r2 = minus<B>(rm1, r0);
+	r3 = plus<B>(divide<B, 2>(minus<B>(r2, r3)), scale<B, 2>(r4));
+	r2 = minus<B>(plus<B>(r2, r1), r4);
+	r1 = minus<B>(r1, r3);
+	std::fill(r, r + na + nb, 0);
+	const Signed *coef[5] = {&r0, &r1, &r2, &r3, &r4}; // all of them >= 0 now.
+	for (size_t i = 0; i < 5; ++i) {
+		addTo<B>(r + i * k, na + nb - i * k, coef[i]->d.data(), coef[i]->d.size());
+	}
+}
+
+template<wide B>
+void mul(limb *r, const limb *a, size_t na, const limb *b, size_t nb) // r[0, na + nb) = a * b, r is neither.
+{
+	if (na < nb) {
+		std::swap(a, b);
+		std::swap(na, nb);
+	}
+	if (nb == 0) {
+		std::fill(r, r + na, 0);
+	} else if (nb < KARATSUBA_THRESHOLD) {
+		mulBasecase<B>(r, a, na, b, nb);
+	} else if (2 * nb <= na) {
+		mulUnbalanced<B>(r, a, na, b, nb);
+	} else if (nb >= TOOM3_THRESHOLD && nb > 2 * ((na + 2) / 3)) {
+		mulToom3<B>(r, a, na, b, nb);
+	} else {
+		mulKaratsuba<B>(r, a, na, b, nb);
+	}
+}
+
+template<wide From, wide To>
+std::vector<limb> convertBasecase(const limb *a, size_t n) // one limb at a time: r = r * From + a[i].
+{
+	std::vector<limb> r;
+	for (size_t i = n; i-- > 0; ) {
+		wide carry = a[i];
+		for (size_t j = 0; j < r.size(); ++j) {
+			const wide t = r[j] * From + carry;
+			r[j] = limb(t % To);
+			carry = t / To;
+		}
+		for (; carry; carry /= To) {
+			r.push_back(limb(carry % To));
+		}
+	}
+	return r;
+}
+
+template<wide From, wide To>
+std::vector<limb> convert(const limb *a, size_t n, const std::vector<std::vector<limb> > &pows)
+{
+	n = trim(a, n);
+	if (n <= CONVERT_THRESHOLD) {
+		return convertBasecase<From, To>(a, n);
+	}
+	size_t k = 0; // a = hi From^s + lo with s = CONVERT_THRESHOLD 2^k < n, pows[k] is From^s in base To.
+	while (k + 1 < pows.size() && (CONVERT_THRESHOLD << (k + 1)) < n) {
+		++k;
+	}
+	const size_t s = CONVERT_THRESHOLD << k;
+	const std::vector<limb> hi = convert<From, To>(a + s, n - s, pows), lo = convert<From, To>(a, s, pows);
+	std::vector<limb> r(hi.size() + pows[k].size());
+	mul<To>(r.data(), hi.data(), hi.size(), pows[k].data(), pows[k].size());
+	addTo<To>(r.data(), r.size(), lo.data(), lo.size());
+	r.resize(trim(r.data(), r.size()));
+	return r;
+}
+
+template<wide From, wide To>
+std::vector<limb> convert(const limb *a, size_t n) // a[0, n) in base From, rewritten in base To.
+{
+	if (trim(a, n) <= CONVERT_THRESHOLD) {
+		return convertBasecase<From, To>(a, trim(a, n));
+	}
+	std::vector<std::vector<limb> > pows; // From^(CONVERT_THRESHOLD 2^k), squared up to about half of a.
+	std::vector<limb> one(CONVERT_THRESHOLD + 1);
+	one.back() = 1;
+	pows.push_back(convertBasecase<From, To>(one.data(), one.size()));
+	while ((CONVERT_THRESHOLD << pows.size()) < n) {
+		const std::vector<limb> &p = pows.back();
+		std::vector<limb> sq(2 * p.size());
+		mul<To>(sq.data(), p.data(), p.size(), p.data(), p.size());
+		sq.resize(trim(sq.data(), sq.size()));
+		pows.push_back(std::move(sq));
+	}
+	return convert<From, To>(a, n, pows);
+}
+
+}
+
 Bint::NewSpaceFailed::NewSpaceFailed() : std::runtime_error("No Enough Memory Space.") {}
 Bint::BadCast::BadCast() : std::invalid_argument("Cannot convert to a Bint object") {}
 
-void Bint::_SafeNewSpace(int *&p, const size_t &len)
+void Bint::_SafeNewSpace(unsigned int *&p, const size_t &len)
 {
 	if (p != nullptr) {
 		delete[] p;
 		p = nullptr;
 	}
-	p = new int[len];
+	p = new unsigned int[len];
 	if (p == nullptr) {
 		throw NewSpaceFailed();
 	}
@@ -84,14 +422,22 @@ void Bint::_SafeNewSpace(int *&p, const size_t &len)
 
 void Bint::_DoubleSpace()
 {
-	int *newMem = nullptr;
+	unsigned int *newMem = nullptr;
 	_SafeNewSpace(newMem, capacity << 1);
-	memcpy(newMem, data, capacity * sizeof(int));
+	memcpy(newMem, data, capacity * sizeof(unsigned int));
 	delete[] data;
 	data = newMem;
 	capacity <<= 1;
 }
 
+void Bint::_Normalize()
+{
+	length = std::max(Limbs::trim(data, length), size_t(1));
+	if (length == 1 && data[0] == 0) {
+		isMinus = false;
+	}
+}
+
 Bint::Bint()
 	: length(1)
 {
@@ -99,37 +445,13 @@ Bint::Bint()
 }
 
 Bint::Bint(int x)
-	: length(0)
-{
-	_SafeNewSpace(data, capacity);
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
-	}
-	while (x) {
-		data[length++] = x % 10000;
-		x /= 10000;
-	}
-	if (!length) {
-		length = 1;
-	}
-}
+	: Bint(static_cast<long long>(x)) {}
 
 Bint::Bint(long long x)
 	: length(0)
 {
 	_SafeNewSpace(data, capacity);
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
-	}
-	while (x) {
-		data[length++] = static_cast<unsigned int>(x % 10000);
-		x /= 10000;
-	}
-	if (!length) {
-		length = 1;
-	}
+	*this = x;
 }
 
 Bint::Bint(const size_t &capa)
@@ -147,40 +469,34 @@ Bint::Bint(std::string x)
 		isMinus = !isMinus;
 		x.erase(0, 1);
 	}
-	while ((capacity << 2) <= x.length()) {
-		capacity <<= 1;
-	}
-
-	_SafeNewSpace(data, capacity);
-
-	size_t mid = x.length() >> 1;
-	for (size_t i = 0; i < mid; ++i) {
-		std::swap(x[i], x[x.length() - 1 - i]);
+	if (x.empty()) {
+		throw BadCast();
 	}
-
-	const static unsigned int pow10[4] = {1, 10, 100, 1000};
-	for (size_t i = 0; i < capacity; ++i) {
-		if ((i << 2) >= x.length()) {
-			length = i;
-			break;
-		}
-		for (size_t j = 0; j < 4; ++j) {
-			if ((i << 2) + j >= x.length()) {
-				break;
-			}
-			if (x[(i << 2) + j] > '9' || x[(i << 2) + j] < '0') {
+	std::vector<Limbs::limb> decimal((x.length() + 8) / 9); // nine digits a limb, from the end of x.
+	for (size_t i = 0; i < decimal.size(); ++i) {
+		const size_t end = x.length() - 9 * i, begin = end > 9 ? end - 9 : 0;
+		for (size_t j = begin; j < end; ++j) {
+			if (x[j] > '9' || x[j] < '0') {
 				throw BadCast();
 			}
-			data[i] = data[i] + (x[(i << 2) + j] - '0') * pow10[j];
+			decimal[i] = decimal[i] * 10 + (x[j] - '0');
 		}
 	}
+	const std::vector<Limbs::limb> binary = Limbs::convert<Limbs::DECIMAL, Limbs::BINARY>(decimal.data(), decimal.size());
+	while (capacity < binary.size()) {
+		capacity <<= 1;
+	}
+	_SafeNewSpace(data, capacity);
+	std::copy(binary.begin(), binary.end(), data);
+	length = binary.size();
+	_Normalize();
 }
 
 Bint::Bint(const Bint &b)
 	: isMinus(b.isMinus), length(b.length), capacity(b.capacity)
 {
 	_SafeNewSpace(data, capacity);
-	memcpy(data, b.data, sizeof(unsigned int) * capacity);
+	memcpy(data, b.data, sizeof(unsigned int) * length);
 }
 
 Bint::Bint(Bint &&b) noexcept
@@ -192,36 +508,23 @@ Bint::Bint(Bint &&b) noexcept
 
 Bint &Bint::operator=(int x)
 {
-	memset(data, 0, sizeof(unsigned int) * capacity);
-	length = 0;
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
-	}
-	while (x) {
-		data[length++] = x % 10000;
-		x /= 10000;
-	}
-	if (!length) {
-		length = 1;
-	}
-	return *this;
+	return *this = static_cast<long long>(x);
 }
 
 Bint &Bint::operator=(long long x)
 {
-	memset(data, 0, sizeof(unsigned int) * capacity);
-	length = 0;
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
+	if (data == nullptr) {
+		_SafeNewSpace(data, capacity);
 	}
-	while (x) {
-		data[length++] = static_cast<unsigned int>(x % 10000);
-		x /= 10000;
+	isMinus = x < 0;
+	unsigned long long m = isMinus ? 0ULL - static_cast<unsigned long long>(x) : x;
+	length = 0;
+	while (m) {
+		data[length++] = static_cast<unsigned int>(m);
+		m >>= 32;
 	}
 	if (!length) {
-		length = 1;
+		data[length++] = 0;
 	}
 	return *this;
 }
@@ -231,11 +534,11 @@ Bint &Bint::operator=(const Bint &rhs)
 	if (this == &rhs) {
 		return *this;
 	}
-	if (rhs.capacity > capacity) {
-		capacity = rhs.capacity;
+	if (rhs.capacity > capacity || data == nullptr) {
+		capacity = std::max(capacity, rhs.capacity);
 		_SafeNewSpace(data, capacity);
 	}
-	memcpy(data, rhs.data, sizeof(unsigned int) * rhs.capacity);
+	memcpy(data, rhs.data, sizeof(unsigned int) * rhs.length);
 	length = rhs.length;
 	isMinus = rhs.isMinus;
 	return *this;
@@ -246,11 +549,10 @@ Bint &Bint::operator=(Bint &&rhs) noexcept
 	if (this == &rhs) {
 		return *this;
 	}
-	capacity = rhs.capacity;
-	length = rhs.length;
-	isMinus = rhs.isMinus;
-	data = rhs.data;
-	rhs.data = nullptr;
+	std::swap(capacity, rhs.capacity);
+	std::swap(length, rhs.length);
+	std::swap(isMinus, rhs.isMinus);
+	std::swap(data, rhs.data); // rhs frees the old limbs.
 	return *this;
 }
 
@@ -270,9 +572,13 @@ std::ostream &operator<<(std::ostream &os, const Bint &b)
 	if (b.isMinus && (b.length > 1 || b.data[0] != 0)) {
 		os << "-";
 	}
-	os << b.data[b.length - 1];
-	for (long long i = b.length - 2LL; i >= 0; --i) {
-		os << std::setw(4) << std::setfill('0') << b.data[i];
+	const std::vector<Limbs::limb> decimal = Limbs::convert<Limbs::BINARY, Limbs::DECIMAL>(b.data, b.length);
+	if (decimal.empty()) {
+		return os << 0;
+	}
+	os << decimal.back();
+	for (long long i = decimal.size() - 2LL; i >= 0; --i) {
+		os << std::setw(9) << std::setfill('0') << decimal[i];
 	}
 	return os;
 }
@@ -325,7 +631,7 @@ bool operator!=(const Bint &lhs, const Bint &rhs)
 bool operator<(const Bint &lhs, const Bint &rhs)
 {
 	if (lhs.isMinus != rhs.isMinus) {
-		return !lhs.isMinus;
+		return lhs.isMinus;
 	}
 	if (lhs.isMinus) {
 		if (lhs.length != rhs.length) {
@@ -358,7 +664,7 @@ bool operator>(const Bint &lhs, const Bint &rhs)
 bool operator<=(const Bint &lhs, const Bint &rhs)
 {
 	if (lhs.isMinus != rhs.isMinus) {
-		return !lhs.isMinus;
+		return lhs.isMinus;
 	}
 	if (lhs.isMinus) {
 		if (lhs.length != rhs.length) {
@@ -386,7 +692,7 @@ bool operator<=(const Bint &lhs, const Bint &rhs)
 bool operator>=(const Bint &lhs, const Bint &rhs)
 {
 	if (lhs.isMinus != rhs.isMinus) {
-		return lhs.isMinus;
+		return !lhs.isMinus;
 	}
 	if (lhs.isMinus) {
 		if (lhs.length != rhs.length) {
@@ -415,20 +721,12 @@ bool operator>=(const Bint &lhs, const Bint &rhs)
 Bint operator+(const Bint &lhs, const Bint &rhs)
 {
 	if (lhs.isMinus == rhs.isMinus) {
-		size_t maxLen = std::max(lhs.length, rhs.length);
-		size_t expectLen = maxLen + 1;
-		Bint result(expectLen); // special constructor
-		for (size_t i = 0; i < maxLen; ++i) {
-			result.data[i] = lhs.data[i] + rhs.data[i];
-		}
-		for (size_t i = 0; i < maxLen; ++i) {
-			if (result.data[i] > 10000) {
-				result.data[i] -= 10000;
-				++result.data[i + 1];
-			}
-		}
-		result.length = result.data[maxLen] > 0 ? maxLen + 1 : maxLen;
+		const Bint &longer = lhs.length >= rhs.length ? lhs : rhs, &shorter = lhs.length >= rhs.length ? rhs : lhs;
+		Bint result(longer.length + 1); // special constructor
+		Limbs::add<Limbs::BINARY>(result.data, longer.data, longer.length, shorter.data, shorter.length);
+		result.length = longer.length + 1;
 		result.isMinus = lhs.isMinus;
+		result._Normalize();
 		return result;
 	} else {
 		if (lhs.isMinus) {
@@ -443,12 +741,14 @@ Bint operator-(const Bint &b)
 {
 	Bint result(b);
 	result.isMinus = !result.isMinus;
+	result._Normalize();
 	return result;
 }
 
 Bint operator-(Bint &&b)
 {
 	b.isMinus = !b.isMinus;
+	b._Normalize();
 	return b;
 }
 
@@ -461,19 +761,10 @@ Bint operator-(const Bint &lhs, const Bint &rhs)
 			if (lhs < rhs) {
 				return -(rhs - lhs);
 			}
-			Bint result(std::max(lhs.length, rhs.length));
-			for (size_t i = 0; i < lhs.length; ++i) {
-				result.data[i] = lhs.data[i] - rhs.data[i];
-			}
-			for (size_t i = 0; i < lhs.length; ++i) {
-				if (result.data[i] < 0) {
-					result.data[i] += 10000;
-					++result.data[i + 1];
-				}
-			}
-			while (result.length > 1 && result.data[result.length - 1] == 0) {
-				--result.length;
-			}
+			Bint result(lhs.length);
+			Limbs::sub<Limbs::BINARY>(result.data, lhs.data, lhs.length, rhs.data, rhs.length);
+			result.length = lhs.length;
+			result._Normalize();
 			return result;
 		}
 	} else {
@@ -483,26 +774,12 @@ Bint operator-(const Bint &lhs, const Bint &rhs)
 
 Bint operator*(const Bint &lhs, const Bint &rhs)
 {
-	size_t expectLen = lhs.length + rhs.length + 2;
+	size_t expectLen = lhs.length + rhs.length;
 	Bint result(expectLen);
-	for (size_t i = 0; i < lhs.length; ++i) {
-		for (size_t j = 0; j < rhs.length; ++j) {
-			long long tmp = result.data[i + j] + static_cast<long long>(lhs.data[i]) * rhs.data[j];
-			if (tmp >= 10000) {
-				result.data[i + j] = tmp % 10000;
-				result.data[i + j + 1] += static_cast<int>(tmp / 10000);
-			} else {
-				result.data[i + j] = tmp;
-			}
-		}
-	}
-	result.length = lhs.length + rhs.length -1;
-	while (result.data[result.length] > 0) {
-		++result.length;
-	}
-	while (result.length > 1 && result.data[result.length - 1] == 0) {
-		--result.length;
-	}
+	Limbs::mul<Limbs::BINARY>(result.data, lhs.data, lhs.length, rhs.data, rhs.length);
+	result.length = expectLen;
+	result.isMinus = lhs.isMinus != rhs.isMinus;
+	result._Normalize();
 	return result;
 }
 
@@ -231,16 +231,16 @@ public:
         iterator(deque* _fa, Block* _blk, DataType* _tar, int _id): fa(_fa), blk(_blk), tar(_tar), id(_id) {}
 		iterator operator + (const int &n) const { auto ret = *this; ret.id += n, n >= 0 ? moveNext(ret.blk, ret.tar, n) : movePrev(ret.blk, ret.tar, -n); return ret; }
 		iterator operator - (const int &n) const { auto ret = *this; ret.id -= n, n >= 0 ? movePrev(ret.blk, ret.tar, n) : moveNext(ret.blk, ret.tar, -n); return ret; }
-		int operator - (const iterator &rhs) const { if(fa != rhs.fa) throw invalid_iterator(); else return id - rhs.id; }
+		int operator - (const iterator &rhs) const { if(fa != rhs.fa) SJTU_THROW(invalid_iterator()); else return id - rhs.id; }
 		iterator& operator += (const int &n) { return *this = *this + n; }
 		iterator& operator -= (const int &n) { return *this = *this - n; }
 		iterator operator ++ (int) { auto ret = *this; return *this = *this + 1, ret; }
 		iterator& operator ++ ()   { return *this = *this + 1; }
 		iterator operator -- (int) { auto ret = *this; return *this = *this - 1, ret; }
 		iterator& operator -- ()   { return *this = *this - 1; }
-        T& operator * () { if(!fa->checkAccessIterator(*this)) throw invalid_iterator(); else return *tar->dat; }
-        const T& operator * () const { if(!fa->checkAccessIterator(*this)) throw invalid_iterator(); return *tar->dat; }
-        T* operator -> () const { if(!fa->checkAccessIterator(*this)) throw invalid_iterator(); return tar->dat; }
+        T& operator * () { if(!fa->checkAccessIterator(*this)) SJTU_THROW(invalid_iterator()); else return *tar->dat; }
+        const T& operator * () const { if(!fa->checkAccessIterator(*this)) SJTU_THROW(invalid_iterator()); return *tar->dat; }
+        T* operator -> () const { if(!fa->checkAccessIterator(*this)) SJTU_THROW(invalid_iterator()); return tar->dat; }
 		bool operator == (const iterator &rhs) const { return fa == rhs.fa && blk == rhs.blk && tar == rhs.tar && id == rhs.id; }
 		bool operator == (const const_iterator &rhs) const { return fa == rhs.fa && blk == rhs.blk && tar == rhs.tar && id == rhs.id; }
 		bool operator != (const iterator &rhs) const { return !(*this == rhs); }
@@ -259,15 +259,15 @@ public:
 			const_iterator(const iterator &other): fa(other.fa), blk(other.blk), tar(other.tar), id(other.id) {}
             const_iterator operator + (const int &n) const { auto ret = *this; ret.id += n, n >= 0 ? moveNext(ret.blk, ret.tar, n) : movePrev(ret.blk, ret.tar, -n); return ret; }
             const_iterator operator - (const int &n) const { auto ret = *this; ret.id -= n, n >= 0 ? movePrev(ret.blk, ret.tar, n) : moveNext(ret.blk, ret.tar, -n); return ret; }
-            int operator - (const const_iterator &rhs) const { if(fa != rhs.fa) throw invalid_iterator(); else return id - rhs.id; }
+            int operator - (const const_iterator &rhs) const { if(fa != rhs.fa) SJTU_THROW(invalid_iterator()); else return id - rhs.id; }
             const_iterator& operator += (const int &n) { return *this = *this + n; }
             const_iterator& operator -= (const int &n) { return *this = *this - n; }
             const_iterator operator ++ (int) { auto ret = *this; return *this = *this + 1, ret; }
             const_iterator& operator ++ ()   { return *this = *this + 1; }
             const_iterator operator -- (int) { auto ret = *this; return *this = *this - 1, ret; }
             const_iterator& operator -- ()   { return *this = *this - 1; }
-            const T& operator * () const { if(!fa->checkAccessIterator(*this)) throw invalid_iterator(); else return *tar->dat; }
-            const T* operator -> () const noexcept { if(!fa->checkAccessIterator(*this)) throw invalid_iterator(); else return tar->dat; }
+            const T& operator * () const { if(!fa->checkAccessIterator(*this)) SJTU_THROW(invalid_iterator()); else return *tar->dat; }
+            const T* operator -> () const noexcept { if(!fa->checkAccessIterator(*this)) SJTU_THROW(invalid_iterator()); else return tar->dat; }
             bool operator == (const iterator &rhs) const { return fa == rhs.fa && blk == rhs.blk && tar == rhs.tar && id == rhs.id; }
             bool operator == (const const_iterator &rhs) const { return fa == rhs.fa && blk == rhs.blk && tar == rhs.tar && id == rhs.id; }
             bool operator != (const iterator &rhs) const { return !(*this == rhs); }
@@ -277,12 +277,12 @@ public:
 	deque(const deque &other): fullSiz(other.fullSiz) { copyAll(other.root); }
 	~deque() { deleteAll(); }
 	deque &operator=(const deque &other) { if(&other != this) deleteAll(), copyAll(other.root), fullSiz = other.fullSiz; return *this; }
-    T & at(const size_t &pos) { if(pos >= size() || pos < 0) throw index_out_of_bound(); else return accessKth(pos); }
-    const T & at(const size_t &pos) const { if(pos >= size() || pos < 0) throw index_out_of_bound(); else return accessKth(pos); }
-    T & operator[] (const size_t &pos) { if(pos >= size() || pos < 0) throw index_out_of_bound(); else return accessKth(pos); }
-    const T & operator[] (const size_t &pos) const { if(pos >= size() || pos < 0) throw index_out_of_bound(); else return accessKth(pos); }
-	const T & front() const { if(empty()) throw container_is_empty(); else return *root.nxt->dat[root.nxt->st].dat; }
-	const T & back() const  { if(empty()) throw container_is_empty(); else return *root.prv->dat[root.prv->ed].dat; }
+    T & at(const size_t &pos) { if(pos >= size() || pos < 0) SJTU_THROW(index_out_of_bound("deque::at")); else return accessKth(pos); }
+    const T & at(const size_t &pos) const { if(pos >= size() || pos < 0) SJTU_THROW(index_out_of_bound("deque::at")); else return accessKth(pos); }
+    T & operator[] (const size_t &pos) { if(pos >= size() || pos < 0) SJTU_THROW(index_out_of_bound("deque::operator[]")); else return accessKth(pos); }
+    const T & operator[] (const size_t &pos) const { if(pos >= size() || pos < 0) SJTU_THROW(index_out_of_bound("deque::operator[]")); else return accessKth(pos); }
+	const T & front() const { if(empty()) SJTU_THROW(container_is_empty()); else return *root.nxt->dat[root.nxt->st].dat; }
+	const T & back() const  { if(empty()) SJTU_THROW(container_is_empty()); else return *root.prv->dat[root.prv->ed].dat; }
 	iterator begin() { return iterator(this, root.nxt, root.nxt->dat + root.nxt->st, 1); }
     const_iterator cbegin() const { return const_iterator(this, root.nxt, root.nxt->dat + root.nxt->st, 1); }
 	iterator end() { return iterator(this, root.prv, root.prv->dat + root.prv->ed + 1, size() + 1); }
@@ -291,21 +291,21 @@ public:
 	size_t size() const { return fullSiz; }
 	void clear() { deleteAll(), checkRoot(), fullSiz = 0; }
 	iterator insert(iterator pos, const T &value) {
-        if(pos.fa != this) throw invalid_iterator();
-        if(size_t(pos.id) > size() + 1) throw invalid_iterator();
+        if(pos.fa != this) SJTU_THROW(invalid_iterator());
+        if(size_t(pos.id) > size() + 1) SJTU_THROW(invalid_iterator());
         insertKth(pos.id, value), ++fullSiz;
         return iteratorKth(pos.id);
 	}
 	iterator erase(iterator pos) {
-	    if(pos.fa != this) throw invalid_iterator();
-	    if(size_t(pos.id) > size()) throw container_is_empty();
+	    if(pos.fa != this) SJTU_THROW(invalid_iterator());
+	    if(size_t(pos.id) > size()) SJTU_THROW(container_is_empty());
 	    removeKth(pos.id), --fullSiz;
 	    return size_t(pos.id) <= size() ? iteratorKth(pos.id) : end();
 	}
 	void push_back(const T &value) { checkRoot(), ++fullSiz, root.prv->push_back(value); }
-	void pop_back() { if(empty()) throw container_is_empty(); else --fullSiz, root.prv->pop_back(); }
+	void pop_back() { if(empty()) SJTU_THROW(container_is_empty()); else --fullSiz, root.prv->pop_back(); }
 	void push_front(const T &value) { checkRoot(), ++fullSiz, root.nxt->push_front(value); }
-	void pop_front() { if(empty()) throw container_is_empty(); else --fullSiz, root.nxt->pop_front(); }
+	void pop_front() { if(empty()) SJTU_THROW(container_is_empty()); else --fullSiz, root.nxt->pop_front(); }
 };
 
 }
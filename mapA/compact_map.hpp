@@ -0,0 +1,354 @@
+/**
+ * a map whose nodes live in one growable array and link to each other by 32 bit indices.
+ * it is a treap, and a node's priority is a hash of its index, so a node holds only its value and two links:
+ * 8 bytes over the payload, and no separate allocation per element.
+ * Parent adds a parent link, so iterators step in O(1) amortized instead of descending from the root again.
+ * Rank adds a subtree size, for select and rank.
+ * each of them adds 4 bytes, so with both a node is 16 bytes over the payload, before padding to its alignment.
+ * every slot also has one bit marking it free. the array doubles when full, so up to half of it may be unused
+ * slots; reserve sizes it exactly.
+ */
+#ifndef SJTU_COMPACT_MAP_HPP
+#define SJTU_COMPACT_MAP_HPP
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+template<bool> struct compact_fa {};
+template<> struct compact_fa<true> { uint32_t fa; };
+template<bool> struct compact_siz {};
+template<> struct compact_siz<true> { uint32_t siz; };
+
+template<class Key, class T, class Compare = std::less<Key>, bool Parent = false, bool Rank = false>
+class compact_map {
+public:
+    class iterator;
+    class const_iterator;
+    typedef pair<const Key, T> value_type;
+private:
+    static constexpr uint32_t NIL = 0xffffffffu, LIMIT = 0xfffffffeu; // indices stay below LIMIT.
+    typedef std::integral_constant<bool, Parent> has_fa;
+    typedef std::integral_constant<bool, Rank> has_siz;
+    struct Node : compact_fa<Parent>, compact_siz<Rank> {
+        value_type v;
+        uint32_t ch[2];
+        template<class... Args>
+        Node(Args&&... args): v(std::forward<Args>(args)...) { ch[0] = ch[1] = NIL; }
+    };
+    struct Free { uint32_t nxt; }; // what a slot on the free list holds instead of a Node.
+    typedef typename std::aligned_storage<sizeof(Node), alignof(Node)>::type Slot;
+
+    Compare comp;
+    Slot* pool; // cap slots, then a bit for each, set while the slot is on the free list.
+    uint32_t cap, used, freed; // used: slots ever handed out, freed: head of the free list.
+    uint32_t root, cnt;
+
+    Node & nd(uint32_t i) { return *reinterpret_cast<Node*>(pool + i); }
+    const Node & nd(uint32_t i) const { return *reinterpret_cast<const Node*>(pool + i); }
+    const Key & key(uint32_t i) const { return nd(i).v.first; }
+    static uint32_t pri(uint32_t i) { // a bijection, so no two nodes tie.
+        i ^= i >> 16, i *= 0x85ebca6bu, i ^= i >> 13, i *= 0xc2b2ae35u, i ^= i >> 16;
+        return i;
+    }
+    static size_t words(size_t n) { return (n + 31) / 32; }
+    static uint32_t* bits(Slot* p, size_t n) { return reinterpret_cast<uint32_t*>(p + n); }
+    bool live(uint32_t i) const { return !(bits(pool, cap)[i / 32] >> i % 32 & 1); }
+    uint32_t nxtFree(uint32_t i) const { return reinterpret_cast<const Free*>(pool + i)->nxt; }
+    void putFree(uint32_t i, uint32_t nxt) { new(pool + i) Free{nxt}, bits(pool, cap)[i / 32] |= 1u << i % 32; } // the slot holds no Node.
+    void takeFree(uint32_t i) { bits(pool, cap)[i / 32] &= ~(1u << i % 32); } // a Node goes into the slot next.
+
+    void linkUp(uint32_t, std::false_type) {}
+    void linkUp(uint32_t i, std::true_type) { for(int d = 0; d < 2; d++) if(nd(i).ch[d] != NIL) nd(nd(i).ch[d]).fa = i; }
+    void pull(uint32_t, std::false_type) {}
+    void pull(uint32_t i, std::true_type) { nd(i).siz = 1 + sizOf(nd(i).ch[0]) + sizOf(nd(i).ch[1]); }
+    uint32_t sizOf(uint32_t i) const { return i == NIL ? 0 : nd(i).siz; }
+    void maintain(uint32_t i) { linkUp(i, has_fa()), pull(i, has_siz()); }
+    void setRoot(uint32_t i, std::false_type) { root = i; }
+    void setRoot(uint32_t i, std::true_type) { if((root = i) != NIL) nd(i).fa = NIL; }
+
+    // the array.
+    template<class... Args>
+    uint32_t alloc(Args&&... args) { // a node built from args, args may refer into the array.
+        if(freed != NIL) {
+            const uint32_t i = freed;
+            freed = nxtFree(i), takeFree(i);
+            SJTU_TRY { new(pool + i) Node(std::forward<Args>(args)...); }
+            SJTU_CATCH_ALL { putFree(i, freed), freed = i; SJTU_RETHROW; }
+            return i;
+        }
+        if(used == cap) growWith(cap ? size_t(cap) * 2 : 16, std::forward<Args>(args)...);
+        else new(pool + used) Node(std::forward<Args>(args)...);
+        return used++;
+    }
+    template<class... Args>
+    void growWith(size_t ncap, Args&&... args) { // the new node goes in first, while args still point at the old array.
+        if(ncap >= LIMIT) ncap = LIMIT - 1;
+        if(ncap <= used) SJTU_THROW(std::bad_alloc()); // out of 32 bit indices.
+        Slot* const np = allocate(ncap);
+        SJTU_TRY { new(np + used) Node(std::forward<Args>(args)...); }
+        SJTU_CATCH_ALL { ::operator delete(np); SJTU_RETHROW; }
+        move(np, ncap);
+    }
+    void grow(size_t ncap) { // only room, for reserve.
+        if(ncap >= LIMIT) ncap = LIMIT - 1;
+        if(ncap <= cap) return;
+        move(allocate(ncap), ncap);
+    }
+    static Slot* allocate(size_t n) { // n slots and their bits, all clear.
+        Slot* const p = static_cast<Slot*>(::operator new(n * sizeof(Slot) + words(n) * sizeof(uint32_t)));
+        memset(bits(p, n), 0, words(n) * sizeof(uint32_t));
+        return p;
+    }
+    void move(Slot* np, size_t ncap) { // every slot of pool goes to the same index of np.
+        for(uint32_t i = 0; i < used; i++) {
+            if(live(i)) new(np + i) Node(std::move(nd(i))), nd(i).~Node();
+            else new(np + i) Free{nxtFree(i)};
+        }
+        if(cap) memcpy(bits(np, ncap), bits(pool, cap), words(cap) * sizeof(uint32_t));
+        ::operator delete(pool);
+        pool = np, cap = uint32_t(ncap);
+    }
+    void release(uint32_t i) { nd(i).~Node(), putFree(i, freed), freed = i; }
+    void destroy() {
+        for(uint32_t i = 0; i < used; i++) if(live(i)) nd(i).~Node();
+        ::operator delete(pool);
+    }
+    void init() { pool = nullptr, cap = used = cnt = 0, freed = root = NIL; }
+    void copyAll(const compact_map &other) { // same indices, so the links copy as they are.
+        init();
+        if(other.used == 0) return;
+        pool = allocate(other.used), cap = other.used;
+        memcpy(bits(pool, cap), bits(other.pool, other.cap), words(cap) * sizeof(uint32_t));
+        uint32_t i = 0;
+        SJTU_TRY {
+            for(; i < other.used; i++) {
+                if(other.live(i)) new(pool + i) Node(other.nd(i));
+                else new(pool + i) Free{other.nxtFree(i)};
+            }
+        } SJTU_CATCH_ALL {
+            used = i, destroy(), init();
+            SJTU_RETHROW;
+        }
+        used = other.used, freed = other.freed, root = other.root, cnt = other.cnt;
+    }
+
+    // the treap, keys inside are distinct.
+    void split(uint32_t pos, const Key &k, uint32_t &l, uint32_t &r) { // l gets the keys less than k.
+        if(pos == NIL) { l = r = NIL; return; }
+        if(comp(key(pos), k)) l = pos, split(nd(pos).ch[1], k, nd(pos).ch[1], r);
+        else r = pos, split(nd(pos).ch[0], k, l, nd(pos).ch[0]);
+        maintain(pos);
+    }
+    uint32_t merge(uint32_t a, uint32_t b) { // every key of a is less than those of b.
+        if(a == NIL || b == NIL) return a == NIL ? b : a;
+        if(pri(a) > pri(b)) { nd(a).ch[1] = merge(nd(a).ch[1], b), maintain(a); return a; }
+        nd(b).ch[0] = merge(a, nd(b).ch[0]), maintain(b);
+        return b;
+    }
+    uint32_t insert(uint32_t pos, uint32_t x) {
+        if(pos == NIL) { maintain(x); return x; }
+        if(pri(x) > pri(pos)) { split(pos, key(x), nd(x).ch[0], nd(x).ch[1]), maintain(x); return x; }
+        const int d = comp(key(pos), key(x));
+        nd(pos).ch[d] = insert(nd(pos).ch[d], x), maintain(pos);
+        return pos;
+    }
+    uint32_t erase(uint32_t pos, const Key &k) { // k must be there.
+        if(comp(key(pos), k)) nd(pos).ch[1] = erase(nd(pos).ch[1], k);
+        else if(comp(k, key(pos))) nd(pos).ch[0] = erase(nd(pos).ch[0], k);
+        else {
+            const uint32_t ret = merge(nd(pos).ch[0], nd(pos).ch[1]);
+            release(pos), --cnt;
+            return ret;
+        }
+        maintain(pos);
+        return pos;
+    }
+    uint32_t link(uint32_t x) { setRoot(insert(root, x), has_fa()), ++cnt; return x; } // x: a new node with a new key.
+    void unlink(uint32_t x) { setRoot(erase(root, key(x)), has_fa()); } // no key is compared once x is gone.
+
+    uint32_t findNode(const Key &k) const {
+        uint32_t pos = root;
+        while(pos != NIL) {
+            if(comp(key(pos), k)) pos = nd(pos).ch[1];
+            else if(comp(k, key(pos))) pos = nd(pos).ch[0];
+            else return pos;
+        }
+        return NIL;
+    }
+    uint32_t lowerBound(const Key &k) const {
+        uint32_t ret = NIL;
+        for(uint32_t pos = root; pos != NIL; ) {
+            if(comp(key(pos), k)) pos = nd(pos).ch[1];
+            else ret = pos, pos = nd(pos).ch[0];
+        }
+        return ret;
+    }
+    uint32_t upperBound(const Key &k) const {
+        uint32_t ret = NIL;
+        for(uint32_t pos = root; pos != NIL; ) {
+            if(comp(k, key(pos))) ret = pos, pos = nd(pos).ch[0];
+            else pos = nd(pos).ch[1];
+        }
+        return ret;
+    }
+    uint32_t lastBelow(uint32_t bound) const { // the greatest key less than bound's, NIL bound means no limit.
+        uint32_t ret = NIL;
+        for(uint32_t pos = root; pos != NIL; ) {
+            if(bound == NIL || comp(key(pos), key(bound))) ret = pos, pos = nd(pos).ch[1];
+            else pos = nd(pos).ch[0];
+        }
+        return ret;
+    }
+    uint32_t edge(uint32_t pos, int d) const { if(pos != NIL) while(nd(pos).ch[d] != NIL) pos = nd(pos).ch[d]; return pos; }
+    uint32_t step(uint32_t pos, int d, std::true_type) const { // d = 1: successor, d = 0: predecessor.
+        if(nd(pos).ch[d] != NIL) return edge(nd(pos).ch[d], !d);
+        uint32_t fa = nd(pos).fa;
+        while(fa != NIL && nd(fa).ch[d] == pos) pos = fa, fa = nd(fa).fa;
+        return fa;
+    }
+    uint32_t step(uint32_t pos, int d, std::false_type) const { return d ? upperBound(key(pos)) : lastBelow(pos); }
+    uint32_t findNxt(uint32_t pos) const { return step(pos, 1, has_fa()); } // pos is not end().
+    uint32_t findPrv(uint32_t pos) const { return pos == NIL ? edge(root, 1) : step(pos, 0, has_fa()); } // NIL when failed.
+
+    uint32_t kth(size_t k) const { // 0-based, NIL when out of range.
+        if(k >= cnt) return NIL;
+        uint32_t pos = root;
+        while(1) {
+            const size_t ls = sizOf(nd(pos).ch[0]);
+            if(k == ls) return pos;
+            if(k < ls) pos = nd(pos).ch[0];
+            else k -= ls + 1, pos = nd(pos).ch[1];
+        }
+    }
+public:
+    class iterator {
+    public:
+        compact_map* bel;
+        uint32_t tar; // NIL is end().
+        iterator(compact_map* _bel = nullptr, uint32_t _tar = NIL): bel(_bel), tar(_tar) {}
+        iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+        iterator & operator++() { if(tar == NIL) SJTU_THROW(invalid_iterator()); tar = bel->findNxt(tar); return *this; }
+        iterator operator--(int) { auto ret = *this; --*this; return ret; }
+        iterator & operator--() { const uint32_t p = bel->findPrv(tar); if(p == NIL) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+        value_type & operator*() const { return bel->nd(tar).v; }
+        value_type* operator->() const noexcept { return &bel->nd(tar).v; }
+        bool operator==(const iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+        bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+    };
+    class const_iterator {
+    public:
+        const compact_map* bel;
+        uint32_t tar;
+        const_iterator(const compact_map* _bel = nullptr, uint32_t _tar = NIL): bel(_bel), tar(_tar) {}
+        const_iterator(const iterator &other): bel(other.bel), tar(other.tar) {}
+        const_iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+        const_iterator & operator++() { if(tar == NIL) SJTU_THROW(invalid_iterator()); tar = bel->findNxt(tar); return *this; }
+        const_iterator operator--(int) { auto ret = *this; --*this; return ret; }
+        const_iterator & operator--() { const uint32_t p = bel->findPrv(tar); if(p == NIL) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+        const value_type & operator*() const { return bel->nd(tar).v; }
+        const value_type* operator->() const noexcept { return &bel->nd(tar).v; }
+        bool operator==(const iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+        bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+    };
+
+    compact_map() { init(); }
+    explicit compact_map(const Compare &_comp): comp(_comp) { init(); }
+    compact_map(const compact_map &other): comp(other.comp) { copyAll(other); }
+    compact_map(compact_map &&other): comp(other.comp), pool(other.pool), cap(other.cap), used(other.used), freed(other.freed), root(other.root), cnt(other.cnt) { other.init(); }
+    compact_map & operator=(const compact_map &other) { if(this != &other) destroy(), comp = other.comp, copyAll(other); return *this; }
+    compact_map & operator=(compact_map &&other) {
+        if(this == &other) return *this;
+        destroy(), comp = other.comp;
+        pool = other.pool, cap = other.cap, used = other.used, freed = other.freed, root = other.root, cnt = other.cnt;
+        other.init();
+        return *this;
+    }
+    ~compact_map() { destroy(); }
+
+    T & at(const Key &key) { const uint32_t tar = findNode(key); if(tar == NIL) SJTU_THROW(index_out_of_bound("compact_map::at")); return nd(tar).v.second; }
+    const T & at(const Key &key) const { const uint32_t tar = findNode(key); if(tar == NIL) SJTU_THROW(index_out_of_bound("compact_map::at")); return nd(tar).v.second; }
+    T & operator[](const Key &key) {
+        uint32_t tar = findNode(key);
+        if(tar == NIL) tar = link(alloc(key, T()));
+        return nd(tar).v.second;
+    }
+    T & operator[](Key &&key) { // a new element takes the key over.
+        uint32_t tar = findNode(key);
+        if(tar == NIL) tar = link(alloc(std::move(key), T()));
+        return nd(tar).v.second;
+    }
+    const T & operator[](const Key &key) const { return at(key); }
+    iterator begin() { return iterator(this, edge(root, 0)); }
+    const_iterator cbegin() const { return const_iterator(this, edge(root, 0)); }
+    iterator end() { return iterator(this, NIL); }
+    const_iterator cend() const { return const_iterator(this, NIL); }
+    bool empty() const { return cnt == 0; }
+    size_t size() const { return cnt; }
+    void clear() { // keeps the array.
+        for(uint32_t i = 0; i < used; i++) if(live(i)) nd(i).~Node();
+        if(cap) memset(bits(pool, cap), 0, words(cap) * sizeof(uint32_t));
+        used = cnt = 0, freed = root = NIL;
+    }
+    void reserve(size_t n) { grow(n); } // room for n elements without moving the array.
+
+    pair<iterator, bool> insert(const value_type &value) {
+        const uint32_t tar = findNode(value.first);
+        if(tar != NIL) return pair<iterator, bool>(iterator(this, tar), 0);
+        return pair<iterator, bool>(iterator(this, link(alloc(value))), 1);
+    }
+    pair<iterator, bool> insert(value_type &&value) { // the value is moved, the const key copied.
+        const uint32_t tar = findNode(value.first);
+        if(tar != NIL) return pair<iterator, bool>(iterator(this, tar), 0);
+        return pair<iterator, bool>(iterator(this, link(alloc(std::move(value)))), 1);
+    }
+    template<class... Args>
+    pair<iterator, bool> emplace(Args&&... args) { // the node is built first, to learn its key.
+        const uint32_t x = alloc(std::forward<Args>(args)...), tar = findNode(key(x));
+        if(tar != NIL) { release(x); return pair<iterator, bool>(iterator(this, tar), 0); }
+        return pair<iterator, bool>(iterator(this, link(x)), 1);
+    }
+    void erase(iterator pos) { if(pos.bel != this || pos.tar == NIL || pos.tar >= used || !live(pos.tar)) SJTU_THROW(invalid_iterator()); unlink(pos.tar); }
+    size_t erase(const Key &key) { const uint32_t tar = findNode(key); if(tar == NIL) return 0; unlink(tar); return 1; }
+    size_t count(const Key &key) const { return findNode(key) != NIL; }
+    iterator find(const Key &key) { return iterator(this, findNode(key)); }
+    const_iterator find(const Key &key) const { return const_iterator(this, findNode(key)); }
+    iterator lower_bound(const Key &key) { return iterator(this, lowerBound(key)); }
+    const_iterator lower_bound(const Key &key) const { return const_iterator(this, lowerBound(key)); }
+    iterator upper_bound(const Key &key) { return iterator(this, upperBound(key)); }
+    const_iterator upper_bound(const Key &key) const { return const_iterator(this, upperBound(key)); }
+
+    // only with Rank.
+    iterator select(size_t k) { // the k-th smallest, 0-based, end() when k >= size().
+        static_assert(Rank, "compact_map::select needs Rank = true");
+        return iterator(this, kth(k));
+    }
+    const_iterator select(size_t k) const {
+        static_assert(Rank, "compact_map::select needs Rank = true");
+        return const_iterator(this, kth(k));
+    }
+    size_t rank(const Key &k) const { // number of keys less than k.
+        static_assert(Rank, "compact_map::rank needs Rank = true");
+        size_t ret = 0;
+        for(uint32_t pos = root; pos != NIL; ) {
+            if(comp(key(pos), k)) ret += sizOf(nd(pos).ch[0]) + 1, pos = nd(pos).ch[1];
+            else pos = nd(pos).ch[0];
+        }
+        return ret;
+    }
+};
+
+}
+
+#endif
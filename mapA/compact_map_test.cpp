@@ -0,0 +1,161 @@
+/**
+ * compact_map against std::map in all four Parent/Rank combinations, then the free list under throwing constructors
+ * and the copies made by the rvalue insert paths.
+ * usage: compact_map_test [operations] [seed]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include "compact_map.hpp"
+
+namespace {
+
+struct Counted { // counts the copies of every instance, moves are free.
+    static long copies;
+    int v;
+    Counted(int _v = 0): v(_v) {}
+    Counted(const Counted &other): v(other.v) { ++copies; }
+    Counted(Counted &&other): v(other.v) {}
+    Counted & operator=(const Counted &other) { v = other.v, ++copies; return *this; }
+    Counted & operator=(Counted &&other) { v = other.v; return *this; }
+    bool operator<(const Counted &rhs) const { return v < rhs.v; }
+};
+long Counted::copies = 0;
+
+struct Fragile { // throws from the constructor taking a negative value, counts the live instances.
+    static long alive;
+    int v;
+    Fragile(int _v = 0): v(_v) { if(v < 0) throw v; ++alive; }
+    Fragile(const Fragile &other): v(other.v) { ++alive; }
+    ~Fragile() { --alive; }
+};
+long Fragile::alive = 0;
+
+typedef std::map<int, std::string> Ref;
+
+int failures = 0;
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+template<class Map>
+void ranks(const Map &m, const Ref &ref, long step, std::true_type) {
+    size_t k = 0;
+    for(auto it = ref.begin(); it != ref.end(); ++it, ++k) EXPECT(m.rank(it->first) == k && m.select(k)->first == it->first);
+    EXPECT(m.select(k) == m.cend());
+}
+template<class Map>
+void ranks(const Map &, const Ref &, long, std::false_type) {}
+
+template<class Map, bool Rank>
+void same(const Map &m, const Ref &ref, long step) { // every element in order, both ways.
+    EXPECT(m.size() == ref.size());
+    auto it = m.cbegin();
+    for(const auto &p : ref) {
+        EXPECT(it != m.cend() && it->first == p.first && it->second == p.second);
+        ++it;
+    }
+    EXPECT(it == m.cend());
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) EXPECT((--it)->first == r->first);
+    bool thrown = false;
+    try { --it; } catch(sjtu::invalid_iterator &) { thrown = true; }
+    EXPECT(thrown);
+    ranks(m, ref, step, std::integral_constant<bool, Rank>());
+}
+
+template<bool Parent, bool Rank>
+void fuzz(long n, unsigned seed, int range) {
+    typedef sjtu::compact_map<int, std::string, std::less<int>, Parent, Rank> Map;
+    Map m;
+    Ref ref;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 8;
+        const std::string v = std::to_string(step);
+        if(op == 0) EXPECT(m.insert(sjtu::pair<const int, std::string>(key, v)).second == ref.insert(std::make_pair(key, v)).second);
+        else if(op == 1) m[key] = v, ref[key] = v;
+        else if(op == 2) EXPECT(m.erase(key) == ref.erase(key));
+        else if(op == 3) {
+            const auto it = m.find(key);
+            EXPECT((it == m.end()) == !ref.count(key));
+            if(it != m.end()) m.erase(it), ref.erase(key);
+        } else if(op == 4) EXPECT(m.emplace(key, v).second == ref.emplace(key, v).second);
+        else if(op == 5) {
+            const auto lb = ref.lower_bound(key), ub = ref.upper_bound(key);
+            const auto mlb = m.lower_bound(key), mub = m.upper_bound(key);
+            EXPECT(lb == ref.end() ? mlb == m.end() : mlb != m.end() && mlb->first == lb->first);
+            EXPECT(ub == ref.end() ? mub == m.end() : mub != m.end() && mub->first == ub->first);
+        } else if(op == 6) {
+            bool thrown = false;
+            try { const std::string got = m.at(key); EXPECT(ref.count(key) && ref.at(key) == got); } catch(sjtu::index_out_of_bound &) { thrown = true; }
+            EXPECT(thrown == !ref.count(key));
+        } else EXPECT(m.count(key) == ref.count(key));
+        if(step % 16384 == 0) { // copies stay apart from the original, moves leave it empty.
+            Map copy(m), assigned;
+            assigned = m;
+            Ref changed(ref);
+            copy[key] = changed[key] = "changed";
+            same<Map, Rank>(assigned, ref, step);
+            Map moved(std::move(assigned));
+            same<Map, Rank>(assigned, Ref(), step), same<Map, Rank>(moved, ref, step);
+            same<Map, Rank>(m, ref, step), same<Map, Rank>(copy, changed, step);
+        } else if(step % 4096 == 0) same<Map, Rank>(m, ref, step);
+        if(step == n / 2) m.clear(), ref.clear();
+        if(failures) return;
+    }
+    same<Map, Rank>(m, ref, n);
+}
+
+void fragile() { // a constructor throwing while a free slot or a grown array is being filled leaks and breaks nothing.
+    long step = 0;
+    {
+        sjtu::compact_map<int, Fragile> m;
+        for(int i = 0; i < 100; i++) m.emplace(i, i);
+        for(int i = 0; i < 100; i += 2) m.erase(i);
+        for(int i = 0; i < 20; i++, step++) { // every other slot is free now.
+            bool thrown = false;
+            try { m.emplace(1000 + i, -1); } catch(int) { thrown = true; }
+            EXPECT(thrown && m.size() == 50 && Fragile::alive == 50);
+        }
+        for(int i = 0; i < 100; i += 2) m.emplace(i, i);
+        for(int i = 0; i < 100; i++) EXPECT(m.at(i).v == i);
+        m.reserve(1000);
+        for(int i = 0; i < 100; i++) EXPECT(m.at(i).v == i);
+        sjtu::compact_map<int, Fragile> copy(m);
+        EXPECT(Fragile::alive == 200 && copy.size() == 100);
+        while(m.size() < 1000) m.emplace(1000 + int(m.size()), 1); // full to the last reserved slot.
+        bool thrown = false;
+        try { m.emplace(-1, -1); } catch(int) { thrown = true; } // the growth fails, the old array stays.
+        EXPECT(thrown && m.size() == 1000 && m.at(0).v == 0);
+    }
+    EXPECT(Fragile::alive == 0);
+}
+
+void copies() { // the rvalue paths move the mapped value and the key handed to operator[].
+    long step = 0;
+    sjtu::compact_map<int, Counted> values;
+    sjtu::compact_map<Counted, int> keys;
+    keys.reserve(100); // growing the array moves the nodes, and moving a pair<const Key, T> copies the key.
+    Counted::copies = 0;
+    for(int i = 0; i < 100; i++) values.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+    for(int i = 0; i < 100; i++) keys[Counted(i)] = i;
+    EXPECT(Counted::copies == 0 && values.size() == 100 && keys.size() == 100);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 100000;
+    const unsigned seed = argc > 2 ? unsigned(atol(argv[2])) : 2333;
+    for(int range : {16, 1000, 1 << 30}) {
+        fuzz<false, false>(n, seed + range, range);
+        fuzz<true, false>(n, seed + range, range);
+        fuzz<false, true>(n, seed + range, range);
+        fuzz<true, true>(n, seed + range, range);
+    }
+    fragile();
+    copies();
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
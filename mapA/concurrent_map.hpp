@@ -0,0 +1,370 @@
+/**
+ * a lock-free skip list with the interface of sjtu::map, for maps that many threads write at once.
+ * a node is unlinked by marking its links first, and freed only when every thread that might still hold it has
+ * moved on to a later epoch.
+ * at without a guard returns a copy. references come from at and find_or_insert taking a concurrent_map::guard, and
+ * stay valid while it is held; a thread that keeps an iterator between calls must hold one too.
+ */
+#ifndef SJTU_CONCURRENT_MAP_HPP
+#define SJTU_CONCURRENT_MAP_HPP
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <atomic>
+#include <thread>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+template<class Key, class T, class Compare = std::less<Key> >
+class concurrent_map {
+public:
+    class iterator;
+    class const_iterator;
+    class guard;
+    typedef pair<const Key, T> value_type;
+private:
+    static constexpr int MAX_LEVEL = 16; // each level keeps a quarter of the one below.
+    static constexpr int THREAD_SLOTS = 128; // threads inside the map at the same time.
+    static constexpr int ADVANCE_EVERY = 64; // retirements between attempts to move the epoch on.
+
+    struct Node {
+        value_type v;
+        std::atomic<unsigned> alive; // the inserter and the remover both drop it, the last one retires the node.
+        Node* gc; // chains retired nodes, readers never look at it.
+        int top;
+        std::atomic<Node*> nxt[1]; // top links, the low bit marks this node as removed at that level.
+    };
+    static Node* mark(Node* p) { return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(p) | 1); }
+    static Node* strip(Node* p) { return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(p) & ~uintptr_t(1)); }
+    static bool marked(Node* p) { return reinterpret_cast<uintptr_t>(p) & 1; }
+    template<class... Args>
+    static Node* newNode(int top, Args&&... args) {
+        Node* const ret = static_cast<Node*>(::operator new(sizeof(Node) + (top - 1) * sizeof(std::atomic<Node*>)));
+        SJTU_TRY { new(&ret->v) value_type(std::forward<Args>(args)...); } SJTU_CATCH_ALL { ::operator delete(ret); SJTU_RETHROW; }
+        new(&ret->alive) std::atomic<unsigned>(2);
+        ret->gc = nullptr, ret->top = top;
+        for(int i = 0; i < top; i++) new(&ret->nxt[i]) std::atomic<Node*>(nullptr);
+        return ret;
+    }
+    static void deleteNode(Node* pos) { pos->v.~value_type(), ::operator delete(pos); }
+
+    struct alignas(64) Slot { // one per thread inside the map, on its own cache line, see newSlots.
+        std::atomic<unsigned long long> epoch; // 0 when idle.
+        std::atomic<bool> busy;
+        Node* limbo[3]; // retired nodes, by epoch % 3.
+        unsigned long long limboEpoch[3];
+        unsigned retired;
+        Slot(): epoch(0), busy(false), retired(0) { for(int i = 0; i < 3; i++) limbo[i] = nullptr, limboEpoch[i] = 0; }
+    };
+
+    Compare comp;
+    std::atomic<Node*> head[MAX_LEVEL];
+    char gap0[64]; // the gaps keep epoch and cnt off the cache lines of other fields, however the map is aligned.
+    std::atomic<unsigned long long> epoch;
+    char gap1[64];
+    std::atomic<long long> cnt;
+    char gap2[64];
+    void* slotMem;
+    Slot* slot;
+
+    static Slot* newSlots(void* &mem) { // operator new aligns only to alignof(max_align_t) before C++17, so round up here.
+        mem = ::operator new(THREAD_SLOTS * sizeof(Slot) + alignof(Slot) - 1);
+        Slot* const ret = reinterpret_cast<Slot*>((reinterpret_cast<uintptr_t>(mem) + alignof(Slot) - 1) & ~uintptr_t(alignof(Slot) - 1));
+        for(int i = 0; i < THREAD_SLOTS; i++) new(ret + i) Slot();
+        return ret;
+    }
+
+    bool less(const Node* a, const Key &b) const { return a != nullptr && comp(a->v.first, b); } // nullptr is the tail, greater than everything.
+    std::atomic<Node*>& next(Node* pred, int lv) const { return pred ? pred->nxt[lv] : const_cast<std::atomic<Node*>&>(head[lv]); } // nullptr pred is the head.
+    static int randomLevel() {
+        static thread_local unsigned seed = unsigned(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        int ret = 1;
+        for(unsigned r = seed; (r & 3) == 0 && ret < MAX_LEVEL; r >>= 2) ++ret;
+        return ret;
+    }
+
+    // epochs.
+    int enter() const { // take a slot and announce the epoch we read in.
+        static thread_local unsigned hint = unsigned(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        concurrent_map* const self = const_cast<concurrent_map*>(this);
+        for(unsigned i = hint; ; ++i) {
+            Slot& s = self->slot[i % THREAD_SLOTS];
+            bool idle = false;
+            if(s.busy.load(std::memory_order_relaxed) || !s.busy.compare_exchange_strong(idle, true)) {
+                if(i - hint >= unsigned(THREAD_SLOTS)) std::this_thread::yield();
+                continue;
+            }
+            hint = i;
+            for(unsigned long long e = epoch.load(), now; ; e = now) {
+                s.epoch.store(e);
+                if((now = epoch.load()) == e) break;
+            }
+            return i % THREAD_SLOTS;
+        }
+    }
+    void leave(int id) const {
+        Slot& s = const_cast<concurrent_map*>(this)->slot[id];
+        s.epoch.store(0, std::memory_order_release);
+        s.busy.store(false, std::memory_order_release);
+    }
+    static void freeChain(Node* pos) { while(pos) { Node* const t = pos; pos = pos->gc; deleteNode(t); } }
+    void retire(int id, Node* pos) { // pos is unlinked everywhere, free it two epochs later.
+        Slot& s = slot[id];
+        const unsigned long long e = s.epoch.load(std::memory_order_relaxed);
+        const int b = e % 3;
+        if(s.limboEpoch[b] != e) freeChain(s.limbo[b]), s.limbo[b] = nullptr, s.limboEpoch[b] = e; // at most e - 3, nobody can reach them.
+        pos->gc = s.limbo[b], s.limbo[b] = pos;
+        if(++s.retired % ADVANCE_EVERY == 0) advance(e);
+    }
+    void advance(unsigned long long e) { // move on once every thread inside has seen e.
+        for(int i = 0; i < THREAD_SLOTS; i++) {
+            const unsigned long long x = slot[i].epoch.load();
+            if(x != 0 && x != e) return;
+        }
+        epoch.compare_exchange_strong(e, e + 1);
+    }
+    struct pin { // the calls below run inside one.
+        const concurrent_map* bel;
+        int id;
+        explicit pin(const concurrent_map* _bel): bel(_bel), id(_bel->enter()) {}
+        ~pin() { bel->leave(id); }
+    };
+
+    // the list, always called inside a pin.
+    bool find(const Key &key, Node** preds, Node** succs) { // unlinks every removed node on the way, true if key is there.
+        retry:
+        Node* pred = nullptr;
+        for(int lv = MAX_LEVEL - 1; lv >= 0; lv--) {
+            Node* cur = strip(next(pred, lv).load());
+            while(cur) {
+                Node* succ = cur->nxt[lv].load();
+                while(marked(succ)) { // cur is being removed, take it out of this level.
+                    Node* expect = cur;
+                    if(!next(pred, lv).compare_exchange_strong(expect, strip(succ))) goto retry;
+                    cur = strip(succ);
+                    if(cur == nullptr) break;
+                    succ = cur->nxt[lv].load();
+                }
+                if(less(cur, key)) pred = cur, cur = strip(succ);
+                else break;
+            }
+            if(preds) preds[lv] = pred, succs[lv] = cur;
+            else if(lv == 0) succs[0] = cur;
+        }
+        return succs[0] != nullptr && !comp(key, succs[0]->v.first);
+    }
+    Node* search(const Key &key) const { // no unlinking, readers only skip removed nodes.
+        Node* pred = nullptr;
+        for(int lv = MAX_LEVEL - 1; lv >= 0; lv--) {
+            Node* cur = strip(next(pred, lv).load());
+            while(cur) {
+                Node* const succ = cur->nxt[lv].load();
+                if(marked(succ)) { cur = strip(succ); continue; }
+                if(less(cur, key)) pred = cur, cur = succ;
+                else break;
+            }
+            if(lv == 0) return cur != nullptr && !comp(key, cur->v.first) ? cur : nullptr;
+        }
+        return nullptr;
+    }
+    template<class... Args>
+    pair<Node*, bool> insert(int id, const Key &key, Args&&... args) {
+        Node *preds[MAX_LEVEL], *succs[MAX_LEVEL];
+        Node* nd = nullptr;
+        while(1) {
+            if(find(key, preds, succs)) {
+                if(nd) deleteNode(nd);
+                return pair<Node*, bool>(succs[0], 0);
+            }
+            if(nd == nullptr) nd = newNode(randomLevel(), std::forward<Args>(args)...);
+            for(int lv = 0; lv < nd->top; lv++) nd->nxt[lv].store(succs[lv], std::memory_order_relaxed);
+            Node* expect = succs[0];
+            if(next(preds[0], 0).compare_exchange_strong(expect, nd)) break;
+        }
+        cnt.fetch_add(1, std::memory_order_relaxed);
+        for(int lv = 1; lv < nd->top; lv++) {
+            while(1) {
+                Node* old = nd->nxt[lv].load();
+                if(marked(old)) goto done; // removed meanwhile, stop building it up.
+                if(old != succs[lv] && !nd->nxt[lv].compare_exchange_strong(old, succs[lv])) goto done;
+                Node* expect = succs[lv];
+                if(next(preds[lv], lv).compare_exchange_strong(expect, nd)) break;
+                find(key, preds, succs);
+                if(succs[0] != nd) goto done; // removed and maybe replaced by a new one.
+            }
+        }
+        done:
+        release(id, nd);
+        return pair<Node*, bool>(nd, 1);
+    }
+    bool remove(int id, Node* nd) { // false if someone else removed it first.
+        for(int lv = nd->top - 1; lv > 0; lv--) {
+            Node* succ = nd->nxt[lv].load();
+            while(!marked(succ) && !nd->nxt[lv].compare_exchange_weak(succ, mark(succ)));
+        }
+        Node* succ = nd->nxt[0].load();
+        while(1) {
+            if(marked(succ)) return false;
+            if(nd->nxt[0].compare_exchange_weak(succ, mark(succ))) break;
+        }
+        cnt.fetch_sub(1, std::memory_order_relaxed);
+        release(id, nd);
+        return true;
+    }
+    void release(int id, Node* nd) { // the last of the inserter and the remover unlinks and retires nd.
+        if(nd->alive.fetch_sub(1) != 1) return;
+        Node* succs[1];
+        find(nd->v.first, nullptr, succs);
+        retire(id, nd);
+    }
+    Node* last() const {
+        Node* pred = nullptr;
+        for(int lv = MAX_LEVEL - 1; lv >= 0; lv--) {
+            for(Node* cur = strip(next(pred, lv).load()); cur; ) {
+                Node* const succ = cur->nxt[lv].load();
+                if(!marked(succ)) pred = cur;
+                cur = strip(succ);
+            }
+        }
+        return pred;
+    }
+    Node* findPrv(Node* pos) const { // the live node before pos, pos == nullptr gives the last one.
+        if(pos == nullptr) return last();
+        Node* pred = nullptr;
+        for(int lv = MAX_LEVEL - 1; lv >= 0; lv--) {
+            for(Node* cur = strip(next(pred, lv).load()); cur && less(cur, pos->v.first); ) {
+                Node* const succ = cur->nxt[lv].load();
+                if(!marked(succ)) pred = cur;
+                cur = strip(succ);
+            }
+        }
+        return pred;
+    }
+    static Node* findNxt(Node* pos) { // skip the removed ones.
+        for(pos = strip(pos->nxt[0].load()); pos && marked(pos->nxt[0].load()); pos = strip(pos->nxt[0].load()));
+        return pos;
+    }
+    Node* nodeBegin() const {
+        Node* pos = strip(head[0].load());
+        return pos && marked(pos->nxt[0].load()) ? findNxt(pos) : pos;
+    }
+public:
+    class guard { // keeps every node this thread can see alive, hold one while using iterators or references.
+        friend class concurrent_map;
+        const concurrent_map* bel;
+        int id;
+    public:
+        explicit guard(const concurrent_map &m): bel(&m), id(m.enter()) {}
+        guard(const guard &) = delete;
+        guard & operator=(const guard &) = delete;
+        ~guard() { bel->leave(id); }
+    };
+    class iterator {
+        public:
+            concurrent_map* bel;
+            Node* tar; // nullptr is end().
+            iterator(concurrent_map* _bel = nullptr, Node* _tar = nullptr): bel(_bel), tar(_tar) {}
+            iterator(const iterator &other): bel(other.bel), tar(other.tar) {}
+            iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+            iterator & operator++() { if(tar == nullptr) SJTU_THROW(invalid_iterator()); tar = findNxt(tar); return *this; }
+            iterator operator--(int) { auto ret = *this; --*this; return ret; }
+            iterator & operator--() { Node* p = bel->findPrv(tar); if(p == nullptr) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+            value_type & operator*() const { return tar->v; }
+            bool operator==(const iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+            value_type* operator->() const noexcept { return &tar->v; }
+    };
+    class const_iterator {
+        public:
+            const concurrent_map* bel;
+            Node* tar;
+            const_iterator(const concurrent_map* _bel = nullptr, Node* _tar = nullptr): bel(_bel), tar(_tar) {}
+            const_iterator(const const_iterator &other): bel(other.bel), tar(other.tar) {}
+            const_iterator(const iterator &other): bel(other.bel), tar(other.tar) {}
+            const_iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+            const_iterator & operator++() { if(tar == nullptr) SJTU_THROW(invalid_iterator()); tar = findNxt(tar); return *this; }
+            const_iterator operator--(int) { auto ret = *this; --*this; return ret; }
+            const_iterator & operator--() { Node* p = bel->findPrv(tar); if(p == nullptr) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+            const value_type & operator*() const { return tar->v; }
+            bool operator==(const iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+            const value_type* operator->() const noexcept { return &tar->v; }
+    };
+
+    concurrent_map(): concurrent_map(Compare()) {}
+    explicit concurrent_map(const Compare &_comp): comp(_comp), epoch(1), cnt(0), slot(newSlots(slotMem)) { for(int i = 0; i < MAX_LEVEL; i++) head[i].store(nullptr); }
+    concurrent_map(const concurrent_map &) = delete;
+    concurrent_map & operator=(const concurrent_map &) = delete;
+    ~concurrent_map() { // no other thread may be left.
+        clear();
+        for(int i = 0; i < THREAD_SLOTS; i++) slot[i].~Slot();
+        ::operator delete(slotMem);
+    }
+
+    T at(const Key &key) const { pin p(this); Node* tar = search(key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("concurrent_map::at")); return tar->v.second; } // a copy, the node may be freed once the call returns.
+    T & at(const guard &held, const Key &key) { // valid while held is.
+        if(held.bel != this) SJTU_THROW(invalid_iterator());
+        Node* tar = search(key);
+        if(tar == nullptr) SJTU_THROW(index_out_of_bound("concurrent_map::at"));
+        return tar->v.second;
+    }
+    const T & at(const guard &held, const Key &key) const { return const_cast<concurrent_map*>(this)->at(held, key); }
+    T & find_or_insert(const guard &held, const Key &key) { // operator[] of map, valid while held is. other threads may write the value meanwhile.
+        if(held.bel != this) SJTU_THROW(invalid_iterator());
+        Node* tar = search(key);
+        if(tar == nullptr) tar = insert(held.id, key, key, T()).first;
+        return tar->v.second;
+    }
+    iterator begin() { pin p(this); return iterator(this, nodeBegin()); }
+    const_iterator cbegin() const { pin p(this); return const_iterator(this, nodeBegin()); }
+    iterator end() { return iterator(this, nullptr); }
+    const_iterator cend() const { return const_iterator(this, nullptr); }
+    bool empty() const { return size() == 0; }
+    size_t size() const { const long long ret = cnt.load(std::memory_order_relaxed); return ret < 0 ? 0 : ret; } // exact once the writers are done.
+    void clear() { // no other thread may use the map meanwhile.
+        Node* pos = strip(head[0].load());
+        for(int i = 0; i < MAX_LEVEL; i++) head[i].store(nullptr);
+        while(pos) { Node* const t = pos; pos = strip(pos->nxt[0].load()); deleteNode(t); }
+        for(int i = 0; i < THREAD_SLOTS; i++) for(int j = 0; j < 3; j++) freeChain(slot[i].limbo[j]), slot[i].limbo[j] = nullptr;
+        cnt.store(0);
+    }
+    pair<iterator, bool> insert(const value_type &value) {
+        pin p(this);
+        auto ret = insert(p.id, value.first, value);
+        return pair<iterator, bool>(iterator(this, ret.first), ret.second);
+    }
+    pair<iterator, bool> insert(value_type &&value) { // the value is moved, the const key copied, so the key stays for the search.
+        pin p(this);
+        auto ret = insert(p.id, value.first, std::move(value));
+        return pair<iterator, bool>(iterator(this, ret.first), ret.second);
+    }
+    void erase(iterator pos) {
+        if(pos.bel != this || pos.tar == nullptr) SJTU_THROW(invalid_iterator());
+        pin p(this);
+        if(!remove(p.id, pos.tar)) SJTU_THROW(invalid_iterator()); // another thread got it first.
+    }
+    size_t erase(const Key &key) {
+        pin p(this);
+        while(1) {
+            Node* const tar = search(key);
+            if(tar == nullptr) return 0;
+            if(remove(p.id, tar)) return 1;
+        }
+    }
+    size_t count(const Key &key) const { pin p(this); return search(key) != nullptr; }
+    iterator find(const Key &key) { pin p(this); return iterator(this, search(key)); }
+    const_iterator find(const Key &key) const { pin p(this); return const_iterator(this, search(key)); }
+};
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * throughput of concurrent_map against map behind one std::mutex.
+ * usage: concurrent_map_bench [threads...] [-r read%]... [-s seconds]
+ * with no thread counts it runs 1, 2, 4, ..., 64, with no read ratio it runs 50%, 90% and 99%.
+ * every thread draws keys from [0, KEYS), a read is a find, a write is an insert or an erase with equal chance.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "map.hpp"
+#include "concurrent_map.hpp"
+
+namespace {
+
+constexpr int KEYS = 1 << 16;
+
+struct locked_map { // the baseline: every call takes the lock.
+    sjtu::map<int, int> core;
+    std::mutex lock;
+    bool find(int key) { std::lock_guard<std::mutex> guard(lock); return core.count(key); }
+    void insert(int key) { std::lock_guard<std::mutex> guard(lock); core.insert(sjtu::pair<const int, int>(key, key)); }
+    void erase(int key) { std::lock_guard<std::mutex> guard(lock); core.erase(key); }
+};
+
+struct lock_free_map {
+    sjtu::concurrent_map<int, int> core;
+    bool find(int key) { return core.count(key); }
+    void insert(int key) { core.insert(sjtu::pair<const int, int>(key, key)); }
+    void erase(int key) { core.erase(key); }
+};
+
+template<class Map>
+double run(int threads, int readPct, double seconds) { // million operations per second over all threads.
+    Map m;
+    for(int i = 0; i < KEYS; i += 2) m.insert(i); // half full, so inserts and erases both do work.
+    std::atomic<bool> go(false), stop(false);
+    std::atomic<long long> total(0), found(0); // found keeps the finds from being optimized away.
+    std::vector<std::thread> th;
+    for(int t = 0; t < threads; t++) th.emplace_back([&, t] {
+        unsigned x = 2333u * (t + 1);
+        long long cnt = 0, hit = 0;
+        while(!go.load()) std::this_thread::yield();
+        while(!stop.load(std::memory_order_relaxed)) {
+            for(int i = 0; i < 256; i++, cnt++) {
+                x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+                const int key = x % KEYS;
+                if(int((x >> 16) & 0x7fff) % 100 < readPct) hit += m.find(key);
+                else if(x >> 31) m.insert(key);
+                else m.erase(key);
+            }
+        }
+        total += cnt, found += hit;
+    });
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for(auto &x : th) x.join();
+    const double used = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total.load() / used / 1e6;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> threads, reads;
+    double seconds = 1;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-r") && i + 1 < argc) reads.push_back(atoi(argv[++i]));
+        else if(!strcmp(argv[i], "-s") && i + 1 < argc) seconds = atof(argv[++i]);
+        else threads.push_back(atoi(argv[i]));
+    }
+    if(threads.empty()) for(int t = 1; t <= 64; t <<= 1) threads.push_back(t);
+    if(reads.empty()) reads = {50, 90, 99};
+    printf("%8s %6s %16s %16s\n", "threads", "read%", "mutex Mops/s", "lock-free Mops/s");
+    for(int r : reads) for(int t : threads)
+        printf("%8d %6d %16.2f %16.2f\n", t, r, run<locked_map>(t, r, seconds), run<lock_free_map>(t, r, seconds));
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * concurrent_map against std::map on one thread, then many threads writing at once.
+ * usage: concurrent_map_test [operations] [threads]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "concurrent_map.hpp"
+
+namespace {
+
+typedef sjtu::concurrent_map<int, int> Map;
+typedef std::map<int, int> Ref;
+
+std::atomic<int> failures(0);
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+void same(const Map &m, const Ref &ref, long step) { // every element in order, both ways, under a guard.
+    Map::guard held(m);
+    EXPECT(m.size() == ref.size());
+    auto it = m.cbegin();
+    for(const auto &p : ref) {
+        EXPECT(it != m.cend() && it->first == p.first && it->second == p.second && &m.at(held, p.first) == &it->second);
+        ++it;
+    }
+    EXPECT(it == m.cend());
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) EXPECT((--it)->first == r->first);
+}
+
+void single(long n, unsigned seed) {
+    Map* const m = new Map; // on the heap, where the slots still have to start on cache lines.
+    Ref ref;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % 2000), op = (seed >> 24) % 7;
+        if(op == 0) EXPECT(m->insert(sjtu::pair<const int, int>(key, int(step))).second == ref.insert(std::make_pair(key, int(step))).second);
+        else if(op == 1) {
+            Map::guard held(*m);
+            m->find_or_insert(held, key) += 1, ref[key] += 1;
+        } else if(op == 2) EXPECT(m->erase(key) == ref.erase(key));
+        else if(op == 3) {
+            const auto it = m->find(key);
+            EXPECT((it == m->end()) == !ref.count(key));
+            if(it != m->end()) m->erase(it), ref.erase(key);
+        } else if(op == 4) {
+            bool thrown = false;
+            try { const int v = m->at(key); EXPECT(ref.count(key) && ref.at(key) == v); } catch(sjtu::index_out_of_bound &) { thrown = true; }
+            EXPECT(thrown == !ref.count(key));
+        } else EXPECT(m->count(key) == ref.count(key));
+        if(step % 4096 == 0) same(*m, ref, step);
+        if(failures) break;
+    }
+    if(!failures) same(*m, ref, n);
+    delete m;
+}
+
+void writers(long n, int threads) { // each thread owns the keys equal to its id mod threads, and all of them fight over [0, 64).
+    long step = 0;
+    Map m;
+    std::vector<std::thread> th;
+    for(int t = 0; t < threads; t++) th.emplace_back([&m, n, t, threads] {
+        unsigned x = 2333u * (t + 1);
+        for(long i = 0; i < n; i++) {
+            x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+            const int own = 64 + int(i % 1000) * threads + t, shared = int(x % 64);
+            if(i < 1000) m.insert(sjtu::pair<const int, int>(own, t));
+            else if(i < 2000 && (own & 1)) m.erase(own);
+            if(x >> 31) m.insert(sjtu::pair<const int, int>(shared, t));
+            else m.erase(shared);
+            if(i % 64 == 0) {
+                Map::guard held(m);
+                int last = -1;
+                for(auto it = m.begin(); it != m.end(); ++it) {
+                    if(it->first <= last) { printf("thread %d: keys out of order\n", t), ++failures; return; }
+                    last = it->first;
+                }
+            }
+        }
+    });
+    for(auto &x : th) x.join();
+    Map::guard held(m);
+    size_t seen = 0;
+    int last = -1;
+    for(auto it = m.cbegin(); it != m.cend(); ++it, ++seen) {
+        EXPECT(it->first > last);
+        last = it->first;
+        if(it->first >= 64) EXPECT(it->second == (it->first - 64) % threads && !(it->first & 1));
+    }
+    EXPECT(seen == m.size());
+    for(int key = 64; key < 64 + 1000 * threads; key++) EXPECT(m.count(key) == !(key & 1));
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 200000;
+    const int threads = argc > 2 ? atoi(argv[2]) : 8;
+    single(n, 2333);
+    writers(n / 10 < 2000 ? 2000 : n / 10, threads);
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
@@ -14,32 +14,54 @@ namespace sjtu {
         class const_iterator;
         typedef pair<const Key, T> value_type;
     private:
+        Compare comp; // kept as a member, so stateful comparators work.
         bool cmp(const value_type* a, const value_type* b) const {
             if(a == nullptr || b == nullptr) return b == nullptr; // nullptr greater than everything.
-            return Compare()(a->first, b->first);
+            return comp(a->first, b->first);
         }
         bool equal(const value_type* a, const value_type* b) const {
             if(a == nullptr || b == nullptr) return a == b;
-            return !Compare()(a->first, b->first) && !Compare()(b->first, a->first);
+            return !comp(a->first, b->first) && !comp(b->first, a->first);
         }
-        bool cmp(const value_type* a, const Key* b) const {
+        template<class K> // K is Key, or anything comparable with Key when Compare::is_transparent exists.
+        bool cmp(const value_type* a, const K* b) const {
             if(a == nullptr || b == nullptr) return b == nullptr; // nullptr greater than everything.
-            return Compare()(a->first, *b);
+            return comp(a->first, *b);
         }
-        bool equal(const value_type* a, const Key* b) const {
+        template<class K>
+        bool equal(const value_type* a, const K* b) const {
             if(a == nullptr || b == nullptr) return 0;
-            return !Compare()(a->first, *b) && !Compare()(*b, a->first);
+            return !comp(a->first, *b) && !comp(*b, a->first);
+        }
+        template<class K>
+        bool cmp(const K* a, const value_type* b) const {
+            if(b == nullptr) return 1;
+            return comp(*a, b->first);
         }
         struct Node {
             value_type* v;
             Node *ls, *rs, *fa;
+            Node *prv, *nxt; // in-order threads, the sentinel is always the last one.
             int siz;
-            Node(value_type* _v = nullptr): v(_v), ls(nullptr), rs(nullptr), fa(nullptr), siz(1) {}
-            Node(const Node &oth): ls(nullptr), rs(nullptr), fa(nullptr), siz(oth.siz) { v = oth.v == nullptr ? nullptr : new value_type(*oth.v); }
+            Node(value_type* _v = nullptr): v(_v), ls(nullptr), rs(nullptr), fa(nullptr), prv(nullptr), nxt(nullptr), siz(1) {}
+            Node(const Node &oth): ls(nullptr), rs(nullptr), fa(nullptr), prv(nullptr), nxt(nullptr), siz(oth.siz) { v = oth.v == nullptr ? nullptr : new value_type(*oth.v); }
             ~Node() { delete  v; }
             void maintain() { siz = (ls ? ls->siz : 0) + (rs ? rs->siz : 0) + 1; }
-            void reset() { ls = rs = fa = nullptr, siz = 1; }
-        }*root;
+            void reset() { ls = rs = fa = prv = nxt = nullptr, siz = 1; }
+        }*root, *head, *tail; // head: leftmost node, tail: the sentinel, which is end().
+
+        void init() { root = head = tail = new Node(); }
+        void linkBefore(Node* pos, Node* succ) {
+            pos->nxt = succ, pos->prv = succ->prv;
+            if(succ->prv) succ->prv->nxt = pos;
+            else head = pos;
+            succ->prv = pos;
+        }
+        void unlink(Node* pos) {
+            if(pos->prv) pos->prv->nxt = pos->nxt;
+            else head = pos->nxt;
+            pos->nxt->prv = pos->prv;
+        }
 
         void fixChain(Node* pos) {
             while(pos) {
@@ -75,46 +97,80 @@ namespace sjtu {
             }
         }
 
-        pair<iterator, bool> insert(value_type* const v) {
-            Node* cur = root;
-            while(1) {
+        Node* finger(Node* const pos, const value_type* const v) { // where the descent for v may start, given a nearby node.
+            if(equal(pos->v, v)) return pos;
+            if(cmp(v, pos->v)) {
+                if(pos->prv == nullptr || cmp(pos->prv->v, v)) return pos->ls ? pos->prv : pos; // one of them has a free slot.
+                Node* cur = pos;
+                while(cur->fa) { // climb until the subtree of cur must contain v.
+                    Node* const fa = cur->fa;
+                    if(cur == fa->rs) {
+                        if(cmp(fa->v, v)) return cur;
+                        if(equal(fa->v, v)) return fa;
+                    }
+                    cur = fa;
+                }
+                return cur;
+            } else {
+                if(cmp(v, pos->nxt->v)) return pos->rs ? pos->nxt : pos;
+                Node* cur = pos;
+                while(cur->fa) {
+                    Node* const fa = cur->fa;
+                    if(cur == fa->ls) {
+                        if(cmp(v, fa->v)) return cur;
+                        if(equal(fa->v, v)) return fa;
+                    }
+                    cur = fa;
+                }
+                return cur;
+            }
+        }
+        pair<Node*, bool> insertNode(Node* cur, value_type* const v, Node* nd) { // descent starts from cur, whose subtree must contain v.
+            while(1) {                                                              // nd is the node to hang, made from v when nullptr.
                 if(equal(cur->v, v)) {
-                    delete v;
                     splay(cur);
-                    return pair<iterator, bool>(iterator(this, cur), 0); // todo: return an iterator.
+                    return pair<Node*, bool>(cur, 0);
                 }
                 if(cmp(cur->v, v)) {
                     if(cur->rs) cur = cur->rs;
                     else {
-                        cur->rs = new Node(v), cur->rs->fa = cur;
+                        cur->rs = nd ? nd : new Node(v), cur->rs->fa = cur;
+                        linkBefore(cur->rs, cur->nxt);
                         cur->maintain(), cur = cur->rs;
                         break;
                     }
                 } else {
                     if(cur->ls) cur = cur->ls;
                     else {
-                        cur->ls = new Node(v), cur->ls->fa = cur;
+                        cur->ls = nd ? nd : new Node(v), cur->ls->fa = cur;
+                        linkBefore(cur->ls, cur);
                         cur->maintain(), cur = cur->ls;
                         break;
                     }
                 }
             }
             splay(cur);
-            return pair<iterator, bool>(iterator(this, cur), 1);
+            return pair<Node*, bool>(cur, 1);
+        }
+        pair<iterator, bool> insert(value_type* const v, Node* cur) {
+            auto ret = insertNode(cur, v, nullptr);
+            if(!ret.second) delete v;
+            return pair<iterator, bool>(iterator(this, ret.first), ret.second);
         }
 
-        void erase(Node* pos) {
+        void detach(Node* pos) { // take pos off the tree and the thread, without freeing it.
+            if(pos->ls == nullptr || pos->rs == nullptr) unlink(pos);
             if(pos->ls == nullptr && pos->rs == nullptr) {
                 if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = nullptr;
                 auto v = pos->fa;
-                delete pos; splay(v);
+                splay(v);
             } else {
                 if(pos->ls == nullptr || pos->rs == nullptr) {
                     Node* son = pos->ls ? pos->ls : pos->rs;
                     if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = son, son->fa = pos->fa;
                     else root = son, son->fa = nullptr;
                     auto v = pos->fa;
-                    delete pos; splay(v);
+                    splay(v);
                 } else {
                     Node *son = pos->ls;
                     while (son->rs) son = son->rs;
@@ -134,11 +190,14 @@ namespace sjtu {
                         if((pos->ls = son_ls)) pos->ls->fa = pos;
                         if((pos->rs = son_rs)) pos->rs->fa = pos;
                     }
-                    erase(pos);
+                    detach(pos);
                 }
             }
         }
-        Node* find(const Key* tar) const {
+        void erase(Node* pos) { detach(pos); delete pos; }
+        void swapContent(map &other) { std::swap(root, other.root), std::swap(head, other.head), std::swap(tail, other.tail), std::swap(comp, other.comp); }
+        template<class K>
+        Node* findNode(const K* tar) const {
             Node* cur = root;
             while(cur) {
                 if(equal(cur->v, tar)) return cur;
@@ -147,85 +206,77 @@ namespace sjtu {
             }
             return nullptr;
         }
-        Node* findPrv(Node* pos) { // return nullptr when failed.
-            if(pos == nullptr) return nullptr;
-            if(pos->ls) {
-                Node* ret = pos->ls;
-                while(ret->rs) ret = ret -> rs;
-                return ret;
-            }
-            while(pos->fa && pos == pos->fa->ls) pos = pos->fa;
-            return pos->fa;
-        }
-        Node* findNxt(Node* pos) {
-            if(pos == nullptr) return nullptr;
-            if(pos->rs) {
-                Node* ret = pos->rs;
-                while(ret->ls) ret = ret -> ls;
-                return ret;
+        // the searches below come in pairs: the const one only descends, O(height), and the height of a splay tree may
+        // be linear; the other splays the deepest node it visited, which makes it amortized O(log n).
+        template<class K>
+        Node* lowerBound(const K* tar, Node* &last) const { // first node not less than tar, tail when failed.
+            Node *cur = root, *ret = tail;
+            last = nullptr; // stays so in an empty tree.
+            while(cur) {
+                last = cur;
+                if(cmp(cur->v, tar)) cur = cur->rs;
+                else ret = cur, cur = cur->ls;
             }
-            while(pos->fa && pos == pos->fa->rs) pos = pos->fa;
-            return pos->fa;
-        }
-        Node* findPrv(const Node* pos) const { // const version of previous two functions.
-            if(pos == nullptr) return nullptr;
-            if(pos->ls) {
-                Node* ret = pos->ls;
-                while(ret->rs) ret = ret -> rs;
-                return ret;
+            return ret;
+        }
+        template<class K>
+        Node* lowerBound(const K* tar) const { Node* last; return lowerBound(tar, last); }
+        template<class K>
+        Node* lowerBound(const K* tar) { Node* last; Node* const ret = lowerBound(tar, last); splay(last); return ret; }
+        template<class K>
+        Node* upperBound(const K* tar, Node* &last) const { // first node greater than tar, tail when failed.
+            Node *cur = root, *ret = tail;
+            last = nullptr; // stays so in an empty tree.
+            while(cur) {
+                last = cur;
+                if(cmp(tar, cur->v)) ret = cur, cur = cur->ls;
+                else cur = cur->rs;
             }
-            while(pos->fa && pos == pos->fa->ls) pos = pos->fa;
-            return pos->fa;
-        }
-        Node* findNxt(const Node* pos) const {
-            if(pos == nullptr) return nullptr;
-            if(pos->rs) {
-                Node* ret = pos->rs;
-                while(ret->ls) ret = ret -> ls;
-                return ret;
+            return ret;
+        }
+        template<class K>
+        Node* upperBound(const K* tar) const { Node* last; return upperBound(tar, last); }
+        template<class K>
+        Node* upperBound(const K* tar) { Node* last; Node* const ret = upperBound(tar, last); splay(last); return ret; }
+        template<class K>
+        size_t rank(const K* tar, Node* &last) const { // number of keys less than tar, counted by siz only.
+            Node* cur = root;
+            size_t ret = 0;
+            last = nullptr;
+            while(cur) {
+                last = cur;
+                if(cmp(cur->v, tar)) ret += (cur->ls ? cur->ls->siz : 0) + 1, cur = cur->rs;
+                else cur = cur->ls;
             }
-            while(pos->fa && pos == pos->fa->rs) pos = pos->fa;
-            return pos->fa;
+            return ret;
         }
+        template<class K>
+        size_t rank(const K* tar) const { Node* last; return rank(tar, last); }
+        template<class K>
+        size_t rank(const K* tar) { Node* last; const size_t ret = rank(tar, last); splay(last); return ret; }
+        Node* findPrv(const Node* pos) const { return pos == nullptr ? nullptr : pos->prv; } // return nullptr when failed.
+        Node* findNxt(const Node* pos) const { return pos == nullptr ? nullptr : pos->nxt; }
 
-        void deleteAll(Node* _pos) {
-            if(_pos == nullptr) return;
-            const int fs = _pos->siz;
-            Node** stk = new Node*[fs + 2];
-            int* step = new int[fs + 2], top = 0;
-            stk[++top] = _pos, step[top] = 0;
-            while(top) {
-                Node* const pos = stk[top];
-                const int ss = step[top--];
-                if(ss == 0) {
-                    stk[++top] = pos, step[top] = 1;
-                    if(pos->ls) stk[++top] = pos->ls, step[top] = 0;
-                } else if(ss == 1) {
-                    stk[++top] = pos, step[top] = 2;
-                    if(pos->rs) stk[++top] = pos->rs, step[top] = 0;
-                } else delete pos;
+        void deleteAll() { // every node is on the thread, so no need to walk the tree.
+            Node* pos = head;
+            while(pos) {
+                Node* const nxt = pos->nxt;
+                delete pos;
+                pos = nxt;
             }
-            delete[] stk;
-            delete[] step;
         }
-        Node* copyAll(Node* cur) {
+        Node* copyAll(Node* cur, Node* &last) { // last: the previous node in in-order.
             if(cur == nullptr) return nullptr;
             Node* ret = new Node(*cur);
-            if(cur->ls) ret->ls = copyAll(cur->ls), ret->ls->fa = ret;
-            if(cur->rs) ret->rs = copyAll(cur->rs), ret->rs->fa = ret;
+            if(cur->ls) ret->ls = copyAll(cur->ls, last), ret->ls->fa = ret;
+            if((ret->prv = last)) last->nxt = ret;
+            else head = ret;
+            last = ret;
+            if(cur->rs) ret->rs = copyAll(cur->rs, last), ret->rs->fa = ret;
             return ret;
         }
+        void copyAll(const map &other) { Node* last = nullptr; root = copyAll(other.root, last), tail = last; }
 
-        Node* nodeBegin() const {
-            Node* cur = root;
-            while(cur->ls) cur = cur->ls;
-            return cur;
-        }
-        Node* nodeEnd() const {
-            Node* cur = root;
-            while(cur->rs) cur = cur->rs;
-            return cur;
-        }
     public:
         class iterator {
         public:
@@ -233,10 +284,10 @@ namespace sjtu {
             Node* tar;
             iterator(map* _bel = nullptr, Node* _tar = nullptr): bel(_bel), tar(_tar) {}
             iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -251,10 +302,10 @@ namespace sjtu {
             const_iterator(const map* _bel = nullptr, const Node* _tar = nullptr): bel(_bel), tar(_tar) {}
             const_iterator(const const_iterator &other):bel(other.bel), tar(other.tar) {}
             const_iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             const value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -262,33 +313,178 @@ namespace sjtu {
             bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
             const value_type* operator->() const noexcept { return tar->v; }
         };
-        map() { root = new Node(); }
-        map(const map &other) { root = copyAll(other.root); }
-        map & operator=(const map &other) { if(this !=&other) deleteAll(root), root = copyAll(other.root); return *this; }
-        ~map() { deleteAll(root); }
-        T & at(const Key &key) { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
-        const T & at(const Key &key) const { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
+        class node_type { // owns a node taken out of a map by extract().
+            friend class map;
+            Node* nd;
+            explicit node_type(Node* _nd): nd(_nd) {}
+        public:
+            node_type(): nd(nullptr) {}
+            node_type(node_type &&other): nd(other.nd) { other.nd = nullptr; }
+            node_type(const node_type &other) = delete;
+            node_type & operator=(node_type &&other) { if(this != &other) delete nd, nd = other.nd, other.nd = nullptr; return *this; }
+            ~node_type() { delete nd; }
+            bool empty() const { return nd == nullptr; }
+            explicit operator bool() const { return nd != nullptr; }
+            const Key & key() const { return nd->v->first; }
+            T & mapped() const { return nd->v->second; }
+        };
+        map() { init(); }
+        explicit map(const Compare &_comp): comp(_comp) { init(); }
+        map(const map &other): comp(other.comp) { copyAll(other); }
+        map(map &&other): comp(other.comp) { root = other.root, head = other.head, tail = other.tail, other.init(); }
+        map & operator=(const map &other) { if(this !=&other) deleteAll(), comp = other.comp, copyAll(other); return *this; }
+        map & operator=(map &&other) { if(this != &other) swapContent(other); return *this; }
+        ~map() { deleteAll(); }
+        T & at(const Key &key) { Node* tar = findNode(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
+        const T & at(const Key &key) const { Node* tar = findNode(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
         T & operator[](const Key &key) {
-            Node* tar = find(&key);
+            Node* tar = findNode(&key);
             if(tar == nullptr) {
                 value_type* nv = new value_type(key, T());
-                tar = insert(nv).first.tar;
+                tar = insert(nv, root).first.tar;
+            }
+            return tar->v->second;
+        }
+        T & operator[](Key &&key) { // a new element takes the key over.
+            Node* tar = findNode(&key);
+            if(tar == nullptr) {
+                value_type* nv = new value_type(std::move(key), T());
+                tar = insert(nv, root).first.tar;
             }
             return tar->v->second;
         }
         const T & operator[](const Key &key) const { return  at(key); }
-        iterator begin() { return iterator(this, nodeBegin()); }
-        const_iterator cbegin() const { return const_iterator(this, nodeBegin()); }
-        iterator end()  { return iterator(this, nodeEnd()); }
-        const_iterator cend() const { return const_iterator(this, nodeEnd()); }
+        iterator begin() { return iterator(this, head); }
+        const_iterator cbegin() const { return const_iterator(this, head); }
+        iterator end()  { return iterator(this, tail); }
+        const_iterator cend() const { return const_iterator(this, tail); }
         bool empty() const { return size() == 0; }
         size_t size() const { return root->siz - 1; }
-        void clear() { deleteAll(root), root = new Node(); }
-        pair<iterator, bool> insert(const value_type &value) { value_type* nv = new value_type(value); return insert(nv); }
-        void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) throw invalid_iterator(); else erase(pos.tar); }
-        size_t count(const Key &key) const { auto tar = find(&key); return tar != nullptr; }
-        iterator find(const Key &key) { auto tar = find(&key); return tar == nullptr ? end() : iterator(this, tar); }
-        const_iterator find(const Key &key) const { auto tar = find(&key); return tar == nullptr ? cend() : const_iterator(this, tar); }
+        void clear() { deleteAll(), init(); }
+        pair<iterator, bool> insert(const value_type &value) { value_type* nv = new value_type(value); return insert(nv, root); }
+        pair<iterator, bool> insert(value_type &&value) { value_type* nv = new value_type(std::move(value)); return insert(nv, root); } // the value is moved, the const key copied.
+        iterator insert(iterator hint, const value_type &value) {
+            if(hint.bel != this || hint.tar == nullptr) SJTU_THROW(invalid_iterator());
+            value_type* nv = new value_type(value);
+            return insert(nv, finger(hint.tar, nv)).first;
+        }
+        iterator insert(iterator hint, value_type &&value) {
+            if(hint.bel != this || hint.tar == nullptr) SJTU_THROW(invalid_iterator());
+            value_type* nv = new value_type(std::move(value));
+            return insert(nv, finger(hint.tar, nv)).first;
+        }
+        template<class... Args>
+        pair<iterator, bool> emplace(Args&&... args) { value_type* nv = new value_type(std::forward<Args>(args)...); return insert(nv, root); }
+        template<class... Args>
+        iterator emplace_hint(iterator hint, Args&&... args) {
+            if(hint.bel != this || hint.tar == nullptr) SJTU_THROW(invalid_iterator());
+            value_type* nv = new value_type(std::forward<Args>(args)...);
+            return insert(nv, finger(hint.tar, nv)).first;
+        }
+        void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) SJTU_THROW(invalid_iterator()); else erase(pos.tar); }
+        size_t count(const Key &key) const { auto tar = findNode(&key); return tar != nullptr; }
+        iterator find(const Key &key) { auto tar = findNode(&key); return tar == nullptr ? end() : iterator(this, tar); }
+        const_iterator find(const Key &key) const { auto tar = findNode(&key); return tar == nullptr ? cend() : const_iterator(this, tar); }
+        iterator lower_bound(const Key &key) { return iterator(this, lowerBound(&key)); }
+        const_iterator lower_bound(const Key &key) const { return const_iterator(this, lowerBound(&key)); }
+        iterator upper_bound(const Key &key) { return iterator(this, upperBound(&key)); }
+        const_iterator upper_bound(const Key &key) const { return const_iterator(this, upperBound(&key)); }
+        pair<iterator, iterator> equal_range(const Key &key) {
+            Node* lb = lowerBound(&key);
+            return pair<iterator, iterator>(iterator(this, lb), iterator(this, equal(lb->v, &key) ? lb->nxt : lb));
+        }
+        pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+            Node* lb = lowerBound(&key);
+            return pair<const_iterator, const_iterator>(const_iterator(this, lb), const_iterator(this, equal(lb->v, &key) ? lb->nxt : lb));
+        }
+        // visit every element in [lo, hi) in order, only the path to lo and the elements inside are touched.
+        template<class Func>
+        void range(const Key &lo, const Key &hi, Func f) { for(Node* cur = lowerBound(&lo); cmp(cur->v, &hi); cur = cur->nxt) f(*cur->v); }
+        template<class Func>
+        void range(const Key &lo, const Key &hi, Func f) const { for(const Node* cur = lowerBound(&lo); cmp(cur->v, &hi); cur = cur->nxt) f(static_cast<const value_type&>(*cur->v)); }
+        size_t count_range(const Key &lo, const Key &hi) { return comp(lo, hi) ? rank(&hi) - rank(&lo) : 0; } // number of keys in [lo, hi).
+        size_t count_range(const Key &lo, const Key &hi) const { return comp(lo, hi) ? rank(&hi) - rank(&lo) : 0; }
+        size_t erase(const Key &key) { Node* tar = findNode(&key); if(tar == nullptr) return 0; erase(tar); return 1; }
+
+        node_type extract(iterator pos) {
+            if(pos.bel != this || pos.tar->v == nullptr) SJTU_THROW(invalid_iterator());
+            detach(pos.tar), pos.tar->reset();
+            return node_type(pos.tar);
+        }
+        node_type extract(const Key &key) {
+            Node* tar = findNode(&key);
+            if(tar == nullptr) return node_type();
+            detach(tar), tar->reset();
+            return node_type(tar);
+        }
+        pair<iterator, bool> insert(node_type &&nh) { // nh keeps its node when the key exists already.
+            if(nh.empty()) return pair<iterator, bool>(end(), 0);
+            auto ret = insertNode(root, nh.nd->v, nh.nd);
+            if(ret.second) nh.nd = nullptr;
+            return pair<iterator, bool>(iterator(this, ret.first), ret.second);
+        }
+        void merge(map &other) { // move over the nodes whose keys are absent here, nothing is reallocated.
+            if(&other == this) return;
+            Node* last = tail;
+            for(Node* pos = other.head; pos != other.tail;) {
+                Node* const nxt = pos->nxt;
+                Node* const start = finger(last, pos->v);
+                Node* cur = start;
+                while(cur && !equal(cur->v, pos->v)) cur = cmp(cur->v, pos->v) ? cur->rs : cur->ls;
+                if(cur == nullptr) other.detach(pos), pos->reset(), last = insertNode(start, pos->v, pos).first;
+                pos = nxt;
+            }
+        }
+        map split(const Key &key) { // keys not less than key move to the returned map.
+            map ret(comp);
+            Node* const pos = lowerBound(&key);
+            if(pos == tail) return ret;
+            if(pos == head) { swapContent(ret); return ret; }
+            splay(pos);
+            Node *const ls = pos->ls, *const last = pos->prv;
+            pos->ls = nullptr, pos->prv = nullptr, pos->maintain(), last->nxt = nullptr;
+            std::swap(tail, ret.tail), ret.root = ret.head = pos; // ret reuses our sentinel, and we take its fresh one.
+            root = ls, ls->fa = nullptr;
+            splay(last);
+            last->rs = tail, tail->fa = last, last->nxt = tail, tail->prv = last;
+            last->maintain();
+            return ret;
+        }
+        void join(map &&other) { // every key of other must be greater than ours.
+            if(&other == this || other.empty()) return;
+            if(empty()) { swapContent(other); return; }
+            Node* const last = tail->prv;
+            if(!cmp(last->v, other.head->v)) SJTU_THROW(runtime_error());
+            splay(last); // now tail is the only node on the right of last.
+            delete tail;
+            last->rs = other.root, other.root->fa = last;
+            last->nxt = other.head, other.head->prv = last;
+            last->maintain();
+            tail = other.tail;
+            other.init();
+        }
+
+        // heterogeneous lookup, only available when Compare::is_transparent exists, so no temporary Key is built.
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        T & at(const K &key) { Node* tar = findNode(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const T & at(const K &key) const { Node* tar = findNode(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        size_t count(const K &key) const { return findNode(&key) != nullptr; }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator find(const K &key) { auto tar = findNode(&key); return tar == nullptr ? end() : iterator(this, tar); }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator find(const K &key) const { auto tar = findNode(&key); return tar == nullptr ? cend() : const_iterator(this, tar); }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator lower_bound(const K &key) { return iterator(this, lowerBound(&key)); }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator lower_bound(const K &key) const { return const_iterator(this, lowerBound(&key)); }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator upper_bound(const K &key) { return iterator(this, upperBound(&key)); }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator upper_bound(const K &key) const { return const_iterator(this, upperBound(&key)); }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        size_t erase(const K &key) { Node* tar = findNode(&key); if(tar == nullptr) return 0; erase(tar); return 1; }
     };
 
 }
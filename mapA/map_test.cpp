@@ -0,0 +1,157 @@
+/**
+ * the splay tree map against std::map, then the copies made by the rvalue insert paths.
+ * usage: map_test [operations] [seed]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include "map.hpp"
+
+namespace {
+
+struct Counted { // counts the copies of every instance, moves are free.
+    static long copies;
+    int v;
+    Counted(int _v = 0): v(_v) {}
+    Counted(const Counted &other): v(other.v) { ++copies; }
+    Counted(Counted &&other): v(other.v) {}
+    Counted & operator=(const Counted &other) { v = other.v, ++copies; return *this; }
+    Counted & operator=(Counted &&other) { v = other.v; return *this; }
+    bool operator<(const Counted &rhs) const { return v < rhs.v; }
+};
+long Counted::copies = 0;
+
+typedef sjtu::map<int, int> Map;
+typedef std::map<int, int> Ref;
+
+int failures = 0;
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+void same(const Map &m, const Ref &ref, long step) { // every element in order, both ways.
+    EXPECT(m.size() == ref.size());
+    auto it = m.cbegin();
+    for(const auto &p : ref) {
+        EXPECT(it != m.cend() && it->first == p.first && it->second == p.second);
+        ++it;
+    }
+    EXPECT(it == m.cend());
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) EXPECT((--it)->first == r->first);
+}
+
+template<class M>
+void bounds(M &m, const Ref &ref, int key, int hi, long step) { // the ordered queries around key, and [key, hi); M is const or not.
+    const auto lb = ref.lower_bound(key), ub = ref.upper_bound(key);
+    const auto mlb = m.lower_bound(key), mub = m.upper_bound(key);
+    EXPECT(lb == ref.end() ? mlb == m.cend() : mlb != m.cend() && mlb->first == lb->first);
+    EXPECT(ub == ref.end() ? mub == m.cend() : mub != m.cend() && mub->first == ub->first);
+    const auto er = m.equal_range(key);
+    EXPECT(er.first == mlb && er.second == mub);
+    size_t inside = 0;
+    long sum = 0;
+    for(auto it = lb; it != ref.end() && it->first < hi; ++it) ++inside, sum += it->second;
+    EXPECT(m.count_range(key, hi) == inside);
+    m.range(key, hi, [&](const sjtu::pair<const int, int> &p) { sum -= p.second; });
+    EXPECT(sum == 0);
+}
+
+void fuzz(long n, unsigned seed, int range) {
+    Map m;
+    Ref ref;
+    bounds(m, ref, 0, range, -1); // an empty tree has no node to splay.
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 10;
+        if(op == 0) EXPECT(m.insert(sjtu::pair<const int, int>(key, int(step))).second == ref.insert(std::make_pair(key, int(step))).second);
+        else if(op == 1) { int k = key; m[std::move(k)] = int(step), ref[key] = int(step); }
+        else if(op == 2) m[key] += 1, ref[key] += 1;
+        else if(op == 3) { // a hint next to the key, or a far one.
+            auto hint = seed & 1 ? m.lower_bound(key) : m.begin();
+            EXPECT(m.insert(hint, sjtu::pair<const int, int>(key, int(step)))->first == key);
+            ref.insert(std::make_pair(key, int(step)));
+        } else if(op == 4) EXPECT(m.emplace(key, int(step)).second == ref.emplace(key, int(step)).second);
+        else if(op == 5 || op == 6) {
+            const auto it = m.find(key);
+            EXPECT((it == m.end()) == !ref.count(key));
+            if(it != m.end()) m.erase(it), ref.erase(key);
+        } else if(op == 7) EXPECT(m.erase(key) == ref.erase(key));
+        else if(op == 8) {
+            bool thrown = false;
+            try { const int v = m.at(key); EXPECT(ref.count(key) && ref.at(key) == v); } catch(sjtu::index_out_of_bound &) { thrown = true; }
+            EXPECT(thrown == !ref.count(key));
+        } else if(seed & 1) bounds(m, ref, key, key + int(seed >> 8) % (range / 4 + 1), step); // these splay.
+        else bounds(static_cast<const Map&>(m), ref, key, key + int(seed >> 8) % (range / 4 + 1), step);
+        if(step % 16384 == 0) { // copies stay apart from the original.
+            Map copy(m), assigned;
+            assigned = m;
+            Ref changed(ref);
+            copy[key] = changed[key] = -1;
+            same(assigned, ref, step), assigned.clear();
+            same(m, ref, step), same(copy, changed, step);
+        } else if(step % 4096 == 0) same(m, ref, step);
+        if(failures) return;
+    }
+    same(m, ref, n);
+}
+
+void nodes(unsigned seed) { // extract, insert(node_type), merge, split and join against their std::map meaning.
+    long step = 0;
+    Map a, b;
+    Ref ra, rb;
+    for(int i = 0; i < 20000; i++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % 50000);
+        if(seed >> 31) a[key] = i, ra[key] = i;
+        else b[key] = i, rb[key] = i;
+    }
+    for(int i = 0; i < 2000; i++, step++) { // move single nodes from a to b, the node stays with a key present in b.
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % 50000);
+        Map::node_type nh = a.extract(key);
+        EXPECT(nh.empty() == !ra.count(key));
+        if(nh.empty()) continue;
+        EXPECT(nh.key() == key && nh.mapped() == ra[key]);
+        const bool fresh = !rb.count(key);
+        EXPECT(b.insert(std::move(nh)).second == fresh && nh.empty() == fresh);
+        if(fresh) rb[key] = ra[key];
+        ra.erase(key);
+    }
+    same(a, ra, step), same(b, rb, step);
+    a.merge(b);
+    for(auto it = rb.begin(); it != rb.end();) {
+        if(ra.insert(*it).second) it = rb.erase(it);
+        else ++it;
+    }
+    same(a, ra, step), same(b, rb, step);
+    Map right = a.split(25000);
+    Ref rr(ra.lower_bound(25000), ra.end());
+    ra.erase(ra.lower_bound(25000), ra.end());
+    same(a, ra, step), same(right, rr, step);
+    a.join(std::move(right));
+    ra.insert(rr.begin(), rr.end());
+    same(a, ra, step), same(right, Ref(), step);
+}
+
+void copies() { // the rvalue paths move the mapped value and the key handed to operator[].
+    long step = 0;
+    sjtu::map<int, Counted> values;
+    sjtu::map<Counted, int> keys;
+    Counted::copies = 0;
+    for(int i = 0; i < 100; i++) values.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+    for(int i = 100; i < 200; i++) values.insert(values.end(), sjtu::pair<const int, Counted>(i, Counted(i)));
+    for(int i = 0; i < 100; i++) keys[Counted(i)] = i;
+    EXPECT(Counted::copies == 0 && values.size() == 200 && keys.size() == 100);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 200000;
+    const unsigned seed = argc > 2 ? unsigned(atol(argv[2])) : 2333;
+    for(int range : {16, 1000, 1 << 30}) fuzz(n, seed + range, range);
+    nodes(seed);
+    copies();
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * a map whose copies share their nodes: copying is O(1), and every update copies only the path it changes.
+ * nodes are reference counted, a node reachable from two versions is never changed, an update copies it instead.
+ */
+#ifndef SJTU_PERSISTENT_MAP_HPP
+#define SJTU_PERSISTENT_MAP_HPP
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "persistent_tree.hpp"
+
+namespace sjtu {
+
+template<class Key, class T, class Compare = std::less<Key> >
+class persistent_map {
+public:
+    class const_iterator;
+    typedef const_iterator iterator; // values are shared between versions, so they are read only.
+    typedef pair<const Key, T> value_type;
+private:
+    typedef persistent_tree<Key, T, Compare> tree;
+    typedef typename tree::Node Node;
+    tree core;
+    Node* root;
+public:
+    class const_iterator {
+        friend class persistent_map;
+        const persistent_map* bel;
+        const Node* tar; // nullptr is end().
+        const_iterator(const persistent_map* _bel, const Node* _tar): bel(_bel), tar(_tar) {}
+    public:
+        const_iterator(): bel(nullptr), tar(nullptr) {}
+        const_iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+        const_iterator & operator++() { if(tar == nullptr) SJTU_THROW(invalid_iterator()); tar = bel->core.nxt(bel->root, tar); return *this; }
+        const_iterator operator--(int) { auto ret = *this; --*this; return ret; }
+        const_iterator & operator--() { const Node* p = bel->core.prv(bel->root, tar); if(p == nullptr) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+        const value_type & operator*() const { return tar->v; }
+        const value_type* operator->() const noexcept { return &tar->v; }
+        bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+    };
+
+    persistent_map(): root(nullptr) {}
+    explicit persistent_map(const Compare &_comp): core(_comp), root(nullptr) {}
+    persistent_map(const persistent_map &other): core(other.core), root(tree::hold(other.root)) {} // O(1), the versions share every node.
+    persistent_map(persistent_map &&other): core(other.core), root(other.root) { other.root = nullptr; }
+    persistent_map & operator=(const persistent_map &other) {
+        Node* const nr = tree::hold(other.root);
+        tree::release(root), core = other.core, root = nr;
+        return *this;
+    }
+    persistent_map & operator=(persistent_map &&other) { if(this != &other) tree::release(root), core = other.core, root = other.root, other.root = nullptr; return *this; }
+    ~persistent_map() { tree::release(root); }
+
+    const T & at(const Key &key) const { const Node* tar = core.find(root, key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("persistent_map::at")); return tar->v.second; }
+    const T & operator[](const Key &key) const { return at(key); }
+    const_iterator begin() const { return const_iterator(this, tree::first(root)); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator end() const { return const_iterator(this, nullptr); }
+    const_iterator cend() const { return end(); }
+    bool empty() const { return root == nullptr; }
+    size_t size() const { return tree::siz(root); }
+    void clear() { tree::release(root), root = nullptr; }
+    size_t count(const Key &key) const { return core.find(root, key) != nullptr; }
+    const_iterator find(const Key &key) const { return const_iterator(this, core.find(root, key)); }
+
+    // updates touch O(log n) nodes, and never change what other versions see.
+    pair<const_iterator, bool> insert(const value_type &value) {
+        const Node* tar = core.find(root, value.first);
+        if(tar == nullptr) root = core.insert(root, value), tar = core.find(root, value.first);
+        else return pair<const_iterator, bool>(const_iterator(this, tar), 0);
+        return pair<const_iterator, bool>(const_iterator(this, tar), 1);
+    }
+    pair<const_iterator, bool> insert(value_type &&value) { // the value is moved, the const key copied, so value.first stays.
+        const Node* tar = core.find(root, value.first);
+        if(tar == nullptr) root = core.insert(root, std::move(value)), tar = core.find(root, value.first);
+        else return pair<const_iterator, bool>(const_iterator(this, tar), 0);
+        return pair<const_iterator, bool>(const_iterator(this, tar), 1);
+    }
+    void insert_or_assign(const Key &key, const T &val) {
+        if(core.find(root, key)) root = core.assign(root, key, val);
+        else root = core.insert(root, value_type(key, val));
+    }
+    size_t erase(const Key &key) {
+        if(core.find(root, key) == nullptr) return 0;
+        root = core.erase(root, key);
+        return 1;
+    }
+    void erase(const_iterator pos) {
+        if(pos.bel != this || pos.tar == nullptr) SJTU_THROW(invalid_iterator());
+        const Key key(pos.tar->v.first); // the node may go away halfway.
+        erase(key);
+    }
+};
+
+}
+
+#endif
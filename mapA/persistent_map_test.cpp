@@ -0,0 +1,93 @@
+/**
+ * persistent_map against std::map, keeping old versions around and checking that no later update reaches them.
+ * usage: persistent_map_test [operations] [seed]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include "persistent_map.hpp"
+
+namespace {
+
+typedef sjtu::persistent_map<int, std::string> Map;
+typedef std::map<int, std::string> Ref;
+
+int failures = 0;
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+void same(const Map &m, const Ref &ref, long step) { // every element in order, both ways.
+    EXPECT(m.size() == ref.size() && m.empty() == ref.empty());
+    auto it = m.cbegin();
+    for(const auto &p : ref) {
+        EXPECT(it != m.cend() && it->first == p.first && it->second == p.second);
+        ++it;
+    }
+    EXPECT(it == m.cend());
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) EXPECT((--it)->first == r->first);
+    bool thrown = false;
+    try { --it; } catch(sjtu::invalid_iterator &) { thrown = true; }
+    EXPECT(thrown);
+}
+
+void fuzz(long n, unsigned seed, int range) {
+    Map m;
+    Ref ref;
+    std::vector<Map> old; // versions taken along the way, with what they held then.
+    std::vector<Ref> was;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 7;
+        const std::string v = std::to_string(step);
+        if(op == 0) EXPECT(m.insert(sjtu::pair<const int, std::string>(key, v)).second == ref.insert(std::make_pair(key, v)).second);
+        else if(op == 1) m.insert_or_assign(key, v), ref[key] = v;
+        else if(op == 2) EXPECT(m.erase(key) == ref.erase(key));
+        else if(op == 3) {
+            const auto it = m.find(key);
+            EXPECT((it == m.end()) == !ref.count(key));
+            if(it != m.end()) m.erase(it), ref.erase(key);
+        } else if(op == 4) {
+            bool thrown = false;
+            try { const std::string got = m.at(key); EXPECT(ref.count(key) && ref.at(key) == got); } catch(sjtu::index_out_of_bound &) { thrown = true; }
+            EXPECT(thrown == !ref.count(key));
+        } else if(op == 5) EXPECT(m.count(key) == ref.count(key));
+        else if(seed >> 31) { // a branch: carry on from an old version, or keep one.
+            if(!old.empty() && (seed & 1)) {
+                const size_t i = (seed >> 1) % old.size();
+                m = old[i], ref = was[i];
+            } else if(old.size() < 64) old.push_back(m), was.push_back(ref);
+            else {
+                const size_t i = (seed >> 1) % old.size();
+                old[i] = m, was[i] = ref;
+            }
+        }
+        if(step % 4096 == 0) {
+            same(m, ref, step);
+            for(size_t i = 0; i < old.size(); i++) same(old[i], was[i], step);
+        }
+        if(step == n / 2) { // a version survives the map it came from.
+            Map* const tmp = new Map(m);
+            Map kept(*tmp);
+            tmp->clear(), delete tmp;
+            same(kept, ref, step);
+            Map moved(std::move(kept));
+            same(kept, Ref(), step), same(moved, ref, step);
+        }
+        if(failures) return;
+    }
+    same(m, ref, n);
+    for(size_t i = 0; i < old.size(); i++) same(old[i], was[i], n);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 200000;
+    const unsigned seed = argc > 2 ? unsigned(atol(argv[2])) : 2333;
+    for(int range : {16, 1000, 1 << 30}) fuzz(n, seed + range, range);
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * a treap with reference-counted nodes, shared by the maps that keep several versions of one tree.
+ * a node reachable from two versions is never changed, an update copies the path it changes instead.
+ */
+#ifndef SJTU_PERSISTENT_TREE_HPP
+#define SJTU_PERSISTENT_TREE_HPP
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <atomic>
+#include "utility.hpp"
+
+namespace sjtu {
+
+template<class Key, class T, class Compare = std::less<Key> >
+class persistent_tree { // Node* arguments and results are owned references.
+public:
+    typedef pair<const Key, T> value_type;
+    struct Node {
+        value_type v;
+        Node *ls, *rs;
+        unsigned pri;
+        int siz;
+        std::atomic<int> ref; // parents and versions holding it.
+        Node(const value_type &_v, unsigned _pri): v(_v), ls(nullptr), rs(nullptr), pri(_pri), siz(1), ref(1) {}
+        Node(value_type &&_v, unsigned _pri): v(std::move(_v)), ls(nullptr), rs(nullptr), pri(_pri), siz(1), ref(1) {}
+        Node(const Node &oth): v(oth.v), ls(hold(oth.ls)), rs(hold(oth.rs)), pri(oth.pri), siz(oth.siz), ref(1) {}
+        void maintain() { siz = (ls ? ls->siz : 0) + (rs ? rs->siz : 0) + 1; }
+    };
+    Compare comp;
+
+    explicit persistent_tree(const Compare &_comp = Compare()): comp(_comp), seed(2333) {}
+    static int siz(const Node* pos) { return pos ? pos->siz : 0; }
+    static Node* hold(Node* pos) { if(pos) pos->ref.fetch_add(1, std::memory_order_relaxed); return pos; }
+    static void release(Node* pos) { // drop one reference, freeing what nobody else holds.
+        while(pos && pos->ref.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Node* const rs = pos->rs;
+            release(pos->ls);
+            delete pos;
+            pos = rs;
+        }
+    }
+    const Node* find(const Node* pos, const Key &key) const {
+        while(pos) {
+            if(comp(pos->v.first, key)) pos = pos->rs;
+            else if(comp(key, pos->v.first)) pos = pos->ls;
+            else return pos;
+        }
+        return nullptr;
+    }
+    const Node* nxt(const Node* root, const Node* pos) const { // re-descend from the root, nodes keep no parent.
+        const Node* ret = nullptr;
+        while(root) {
+            if(comp(pos->v.first, root->v.first)) ret = root, root = root->ls;
+            else root = root->rs;
+        }
+        return ret;
+    }
+    const Node* prv(const Node* root, const Node* pos) const { // pos == nullptr gives the last one.
+        const Node* ret = nullptr;
+        while(root) {
+            if(pos == nullptr || comp(root->v.first, pos->v.first)) ret = root, root = root->rs;
+            else root = root->ls;
+        }
+        return ret;
+    }
+    static const Node* first(const Node* pos) { if(pos) while(pos->ls) pos = pos->ls; return pos; }
+    Node* insert(Node* root, const value_type &value) { return insert(root, new Node(value, rnd())); } // value.first must be new.
+    Node* insert(Node* root, value_type &&value) { return insert(root, new Node(std::move(value), rnd())); }
+    Node* assign(Node* pos, const Key &key, const T &val) { // key must be there.
+        pos = own(pos);
+        if(comp(pos->v.first, key)) pos->rs = assign(pos->rs, key, val);
+        else if(comp(key, pos->v.first)) pos->ls = assign(pos->ls, key, val);
+        else pos->v.second = val;
+        return pos;
+    }
+    Node* erase(Node* pos, const Key &key) { // key must be there.
+        if(comp(pos->v.first, key)) pos = own(pos), pos->rs = erase(pos->rs, key);
+        else if(comp(key, pos->v.first)) pos = own(pos), pos->ls = erase(pos->ls, key);
+        else {
+            Node* const ret = merge(hold(pos->ls), hold(pos->rs));
+            release(pos);
+            return ret;
+        }
+        pos->maintain();
+        return pos;
+    }
+private:
+    unsigned seed;
+    unsigned rnd() { seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5; return seed; }
+    Node* own(Node* pos) { // a node we may change in place: pos itself if nobody else holds it, a copy otherwise.
+        if(pos->ref.load(std::memory_order_acquire) == 1) return pos;
+        Node* const ret = new Node(*pos);
+        release(pos);
+        return ret;
+    }
+    void split(Node* pos, const Key &key, Node*& l, Node*& r) { // l gets the keys less than key.
+        if(pos == nullptr) { l = r = nullptr; return; }
+        pos = own(pos);
+        if(comp(pos->v.first, key)) split(pos->rs, key, pos->rs, r), l = pos;
+        else split(pos->ls, key, l, pos->ls), r = pos;
+        pos->maintain();
+    }
+    Node* merge(Node* a, Node* b) { // every key of a is less than those of b.
+        if(a == nullptr || b == nullptr) return a ? a : b;
+        if(a->pri > b->pri) { a = own(a), a->rs = merge(a->rs, b), a->maintain(); return a; }
+        b = own(b), b->ls = merge(a, b->ls), b->maintain();
+        return b;
+    }
+    Node* insert(Node* pos, Node* nd) {
+        if(pos == nullptr) return nd;
+        if(nd->pri > pos->pri) { split(pos, nd->v.first, nd->ls, nd->rs), nd->maintain(); return nd; }
+        pos = own(pos);
+        if(comp(pos->v.first, nd->v.first)) pos->rs = insert(pos->rs, nd);
+        else pos->ls = insert(pos->ls, nd);
+        pos->maintain();
+        return pos;
+    }
+};
+
+}
+
+#endif
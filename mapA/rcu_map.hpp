@@ -0,0 +1,191 @@
+/**
+ * a map shared by many readers and one writer at a time.
+ * the writer never touches a published node: every update copies the path it changes into a new version (see
+ * persistent_tree) and publishes it with one atomic store, readers pin a version and walk it without locks.
+ */
+#ifndef SJTU_RCU_MAP_HPP
+#define SJTU_RCU_MAP_HPP
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "persistent_tree.hpp"
+
+namespace sjtu {
+
+template<class Key, class T, class Compare = std::less<Key> >
+class rcu_map {
+public:
+    typedef pair<const Key, T> value_type;
+    class snapshot;
+private:
+    static constexpr int READER_SLOTS = 128; // readers pinning a version at the same time.
+    typedef persistent_tree<Key, T, Compare> tree;
+    typedef typename tree::Node Node;
+    struct Version {
+        Node* root; // one reference, dropped once no reader can be on this version.
+        Version* nxt; // the next newer version, only the writer follows it.
+        Version(Node* _root): root(_root), nxt(nullptr) {}
+    };
+    struct alignas(64) Slot { // one cache line each, so readers do not fight over them, see newSlots.
+        std::atomic<Version*> ver; // may point to a freed version until the reader checks it, so only compare it.
+        std::atomic<bool> busy;
+        Slot(): ver(nullptr), busy(false) {}
+    };
+
+    tree core; // only the writer changes it.
+    char gap0[64]; // the gaps keep cur off the cache lines of the writer's fields, however the map is aligned.
+    std::atomic<Version*> cur;
+    char gap1[64];
+    void* slotMem;
+    Slot* slot;
+    std::mutex lock; // serializes writers.
+    Version* oldest; // versions still waiting for their readers, from oldest to cur.
+
+    static Slot* newSlots(void* &mem) { // operator new aligns only to alignof(max_align_t) before C++17, so round up here.
+        mem = ::operator new(READER_SLOTS * sizeof(Slot) + alignof(Slot) - 1);
+        Slot* const ret = reinterpret_cast<Slot*>((reinterpret_cast<uintptr_t>(mem) + alignof(Slot) - 1) & ~uintptr_t(alignof(Slot) - 1));
+        for(int i = 0; i < READER_SLOTS; i++) new(ret + i) Slot();
+        return ret;
+    }
+
+    // readers.
+    int pin() const { // take a free slot, then announce the version we read and check it is still the current one.
+        static thread_local unsigned hint = unsigned(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        rcu_map* const self = const_cast<rcu_map*>(this);
+        for(unsigned i = hint; ; ++i) {
+            Slot& s = self->slot[i % READER_SLOTS];
+            bool idle = false;
+            if(s.busy.load(std::memory_order_relaxed) || !s.busy.compare_exchange_strong(idle, true)) {
+                if(i - hint >= unsigned(READER_SLOTS)) std::this_thread::yield();
+                continue;
+            }
+            hint = i;
+            for(Version *v = cur.load(), *now; ; v = now) {
+                s.ver.store(v);
+                if((now = cur.load()) == v) break;
+            }
+            return i % READER_SLOTS;
+        }
+    }
+    void unpin(int id) const {
+        rcu_map* const self = const_cast<rcu_map*>(this);
+        self->slot[id].ver.store(nullptr, std::memory_order_release);
+        self->slot[id].busy.store(false, std::memory_order_release);
+    }
+
+    // the writer, always holding lock.
+    Node* latest() const { return tree::hold(cur.load(std::memory_order_relaxed)->root); } // a reference for the next update.
+    void publish(Node* root) { // make root the current version, then free what no reader can see any more.
+        Version* const old = cur.load(std::memory_order_relaxed);
+        old->nxt = new Version(root);
+        cur.store(old->nxt);
+        reclaim();
+    }
+    void reclaim() { // free from the oldest version up to the first one a slot points to.
+        const Version* pinned[READER_SLOTS];
+        int cnt = 0;
+        for(int i = 0; i < READER_SLOTS; i++) if(const Version* v = slot[i].ver.load()) pinned[cnt++] = v;
+        // a reader pinning after the scan checks its version against cur, so it never keeps an older one.
+        for(const Version* const now = cur.load(std::memory_order_relaxed); oldest != now; ) {
+            for(int i = 0; i < cnt; i++) if(pinned[i] == oldest) return;
+            Version* const v = oldest;
+            oldest = v->nxt;
+            tree::release(v->root), delete v;
+        }
+    }
+public:
+    class snapshot { // one consistent version, valid until the snapshot is destroyed.
+        friend class rcu_map;
+        const rcu_map* bel;
+        const Node* root;
+        int id;
+        snapshot(const rcu_map* _bel): bel(_bel), id(_bel->pin()) { root = bel->slot[id].ver.load()->root; }
+    public:
+        class const_iterator {
+            friend class snapshot;
+            const snapshot* bel;
+            const Node* tar; // nullptr is end().
+            const_iterator(const snapshot* _bel, const Node* _tar): bel(_bel), tar(_tar) {}
+        public:
+            const_iterator(): bel(nullptr), tar(nullptr) {}
+            const_iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+            const_iterator & operator++() { if(tar == nullptr) SJTU_THROW(invalid_iterator()); tar = bel->bel->core.nxt(bel->root, tar); return *this; }
+            const_iterator operator--(int) { auto ret = *this; --*this; return ret; }
+            const_iterator & operator--() { const Node* p = bel->bel->core.prv(bel->root, tar); if(p == nullptr) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+            const value_type & operator*() const { return tar->v; }
+            const value_type* operator->() const noexcept { return &tar->v; }
+            bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+        snapshot(const snapshot &) = delete;
+        snapshot & operator=(const snapshot &) = delete;
+        snapshot(snapshot &&other): bel(other.bel), root(other.root), id(other.id) { other.bel = nullptr; }
+        ~snapshot() { if(bel) bel->unpin(id); }
+        size_t size() const { return tree::siz(root); }
+        bool empty() const { return root == nullptr; }
+        const_iterator begin() const { return const_iterator(this, tree::first(root)); }
+        const_iterator end() const { return const_iterator(this, nullptr); }
+        const_iterator find(const Key &key) const { return const_iterator(this, bel->core.find(root, key)); }
+        size_t count(const Key &key) const { return bel->core.find(root, key) != nullptr; }
+        const T & at(const Key &key) const { const Node* p = bel->core.find(root, key); if(p == nullptr) SJTU_THROW(index_out_of_bound("rcu_map::at")); return p->v.second; }
+    };
+
+    rcu_map(): rcu_map(Compare()) {}
+    explicit rcu_map(const Compare &_comp): core(_comp), slot(newSlots(slotMem)) { cur.store(oldest = new Version(nullptr)); }
+    rcu_map(const rcu_map &) = delete;
+    rcu_map & operator=(const rcu_map &) = delete;
+    ~rcu_map() { // no reader may be left.
+        while(oldest) {
+            Version* const v = oldest;
+            oldest = v->nxt;
+            tree::release(v->root), delete v;
+        }
+        for(int i = 0; i < READER_SLOTS; i++) slot[i].~Slot();
+        ::operator delete(slotMem);
+    }
+
+    snapshot read() const { return snapshot(this); } // readers never wait for the writer.
+    size_t size() const { return read().size(); }
+    bool empty() const { return size() == 0; }
+    size_t count(const Key &key) const { return read().count(key); }
+    T at(const Key &key) const { return read().at(key); } // a copy, the node may be gone once the read ends.
+
+    bool insert(const value_type &value) { // false if the key is there already.
+        std::lock_guard<std::mutex> guard(lock);
+        if(core.find(cur.load(std::memory_order_relaxed)->root, value.first)) return false;
+        publish(core.insert(latest(), value));
+        return true;
+    }
+    bool insert(value_type &&value) { // the value is moved into the new node.
+        std::lock_guard<std::mutex> guard(lock);
+        if(core.find(cur.load(std::memory_order_relaxed)->root, value.first)) return false;
+        publish(core.insert(latest(), std::move(value)));
+        return true;
+    }
+    void insert_or_assign(const Key &key, const T &val) {
+        std::lock_guard<std::mutex> guard(lock);
+        if(core.find(cur.load(std::memory_order_relaxed)->root, key)) publish(core.assign(latest(), key, val));
+        else publish(core.insert(latest(), value_type(key, val)));
+    }
+    size_t erase(const Key &key) {
+        std::lock_guard<std::mutex> guard(lock);
+        if(core.find(cur.load(std::memory_order_relaxed)->root, key) == nullptr) return 0;
+        publish(core.erase(latest(), key));
+        return 1;
+    }
+    void clear() {
+        std::lock_guard<std::mutex> guard(lock);
+        publish(nullptr);
+    }
+};
+
+}
+
+#endif
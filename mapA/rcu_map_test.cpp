@@ -0,0 +1,110 @@
+/**
+ * rcu_map against std::map on one thread, with snapshots that must not see later updates,
+ * then writers and readers at once.
+ * usage: rcu_map_test [operations] [readers]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "rcu_map.hpp"
+
+namespace {
+
+typedef sjtu::rcu_map<int, std::string> Map;
+typedef std::map<int, std::string> Ref;
+
+std::atomic<int> failures(0);
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+void same(const Map::snapshot &s, const Ref &ref, long step) { // every element in order, both ways.
+    EXPECT(s.size() == ref.size() && s.empty() == ref.empty());
+    auto it = s.begin();
+    for(const auto &p : ref) {
+        EXPECT(it != s.end() && it->first == p.first && it->second == p.second && s.find(p.first) == it);
+        ++it;
+    }
+    EXPECT(it == s.end());
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) EXPECT((--it)->first == r->first);
+}
+
+void single(long n, unsigned seed, int range) {
+    Map* const m = new Map; // on the heap, where the slots still have to start on cache lines.
+    Ref ref;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 6;
+        const std::string v = std::to_string(step);
+        if(op == 0) EXPECT(m->insert(sjtu::pair<const int, std::string>(key, v)) == ref.insert(std::make_pair(key, v)).second);
+        else if(op == 1) m->insert_or_assign(key, v), ref[key] = v;
+        else if(op == 2) EXPECT(m->erase(key) == ref.erase(key));
+        else if(op == 3) {
+            bool thrown = false;
+            try { const std::string got = m->at(key); EXPECT(ref.count(key) && ref.at(key) == got); } catch(sjtu::index_out_of_bound &) { thrown = true; }
+            EXPECT(thrown == !ref.count(key));
+        } else EXPECT(m->count(key) == ref.count(key));
+        if(step % 4096 == 0) { // a snapshot keeps its version through the next updates and a clear.
+            const Map::snapshot s = m->read();
+            const Ref kept(ref);
+            for(int i = 0; i < 100; i++) m->insert_or_assign(i, "later"), ref[i] = "later";
+            same(s, kept, step);
+            if(step == 0) m->clear(), ref.clear(), same(s, kept, step);
+            same(m->read(), ref, step);
+        }
+        if(failures) break;
+    }
+    if(!failures) same(m->read(), ref, n);
+    delete m;
+}
+
+void shared(long n, int readers) { // each writer slides a window of keys of its own, readers must always see whole windows.
+    const int WRITERS = 2, SPACE = 1 << 24, WINDOW = 500;
+    Map m;
+    for(int t = 0; t < WRITERS; t++) for(int i = 0; i < WINDOW; i++) m.insert(sjtu::pair<const int, std::string>(t * SPACE + i, std::to_string(i)));
+    std::atomic<int> done(0);
+    std::vector<std::thread> th;
+    for(int t = 0; t < WRITERS; t++) th.emplace_back([&m, &done, n, t, SPACE, WINDOW] {
+        const int base = t * SPACE;
+        for(long i = 0; i < n; i++) { // grow at the top, then shrink at the bottom: the window holds WINDOW or WINDOW + 1 keys.
+            m.insert(sjtu::pair<const int, std::string>(base + WINDOW + int(i), std::to_string(WINDOW + i)));
+            m.erase(base + int(i));
+        }
+        ++done;
+    });
+    for(int r = 0; r < readers; r++) th.emplace_back([&m, &done, r, SPACE, WINDOW, WRITERS] {
+        while(done.load() < WRITERS) {
+            const Map::snapshot s = m.read();
+            int first[WRITERS], cnt[WRITERS] = {}, last = -1;
+            for(auto it = s.begin(); it != s.end(); ++it) {
+                const int w = it->first / SPACE;
+                if(it->first <= last || it->second != std::to_string(it->first % SPACE)) { printf("reader %d: a broken element\n", r), ++failures; return; }
+                if(cnt[w]++ == 0) first[w] = it->first;
+                else if(it->first != first[w] + cnt[w] - 1) { printf("reader %d: a hole in the window\n", r), ++failures; return; }
+                last = it->first;
+            }
+            for(int w = 0; w < WRITERS; w++) if(cnt[w] != WINDOW && cnt[w] != WINDOW + 1) {
+                printf("reader %d: a window of %d keys\n", r, cnt[w]), ++failures; return;
+            }
+        }
+    });
+    for(auto &x : th) x.join();
+    Ref ref;
+    for(int t = 0; t < WRITERS; t++) for(int i = 0; i < WINDOW; i++) ref[t * SPACE + int(n) + i] = std::to_string(n + i);
+    same(m.read(), ref, n);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 200000;
+    const int readers = argc > 2 ? atoi(argv[2]) : 4;
+    for(int range : {16, 1000, 1 << 30}) single(n, 2333 + range, range);
+    shared(n / 10 < 1000 ? 1000 : n / 10, readers);
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
@@ -60,135 +60,92 @@ private:
         }
         fa->maintain(), pos->maintain();
     }
-    void maintain(Node* pos) {
-        if(pos->ls == nullptr || pos->rs == nullptr) {
-            if(pos->ls == nullptr && pos->rs == nullptr) return;
-            if(pos->ls != nullptr) {
-                if(pos->ls->ls) {
-                    const auto l = pos->ls;
-                    rotate(l);
-                    maintain(pos);
-                    maintain(l);
-                } else if(pos->ls->rs) {
-                    const auto l = pos->ls, b = pos->ls->rs;
-                    rotate(b);
-                    rotate(b);
-                    maintain(l);
-                    maintain(pos);
-                    maintain(b);
-                }
-            } else {
-                if(pos->rs->rs) {
-                    const auto l = pos->rs;
-                    rotate(l);
-                    maintain(pos);
-                    maintain(l);
-                } else if(pos->rs->ls) {
-                    const auto l = pos->rs, b = pos->rs->ls;
-                    rotate(b);
-                    rotate(b);
-                    maintain(l);
-                    maintain(pos);
-                    maintain(b);
-                }
+    static int siz(const Node* pos) { return pos ? pos->siz : 0; }
+    static constexpr int FIX_DEPTH = 64; // pending subtrees of one fix, more than that go to a nested fix with a fresh stack.
+    void fix(Node*& top, bool right) { // restore the SBT invariant of the subtree hanging on top, right means its right side grew.
+        Node** slot[FIX_DEPTH];
+        bool dir[FIX_DEPTH];
+        int n = 0;
+        slot[n] = &top, dir[n++] = right;
+        while(n) {
+            --n;
+            Node** const s = slot[n];
+            const bool r = dir[n];
+            Node* const t = *s;
+            Node* const a = r ? t->rs : t->ls;
+            if(a == nullptr) continue;
+            const int lim = siz(r ? t->ls : t->rs);
+            Node* const inner = r ? a->ls : a->rs;
+            if(siz(r ? a->rs : a->ls) > lim) rotate(a);
+            else if(siz(inner) > lim) rotate(inner), rotate(inner);
+            else continue;
+            Node* const nt = *s; // links are rewritten in place, so s now holds the new subtree root.
+            if(n + 4 > FIX_DEPTH) { // same order as the pushes below would pop, nothing is dropped.
+                fix(nt->ls, 0), fix(nt->rs, 1), fix(*s, 0), fix(*s, 1);
+                continue;
             }
-            return;
-        }
-        if(pos->ls->ls && pos->ls->ls->siz > pos->rs->siz) {
-            const auto l = pos->ls;
-            rotate(l);
-            maintain(pos);
-            maintain(l);
-        } else if(pos->ls->rs && pos->ls->rs->siz > pos->rs->siz) {
-            const auto l = pos->ls, b = pos->ls->rs;
-            rotate(b);
-            rotate(b);
-            maintain(l);
-            maintain(pos);
-            maintain(b);
-        } else if(pos->rs->rs && pos->rs->rs->siz > pos->ls->siz) {
-            const auto l = pos->rs;
-            rotate(l);
-            maintain(pos);
-            maintain(l);
-        } else if(pos->rs->ls && pos->rs->ls->siz > pos->ls->siz) {
-            const auto l = pos->rs, b = pos->rs->ls;
-            rotate(b);
-            rotate(b);
-            maintain(l);
-            maintain(pos);
-            maintain(b);
+            slot[n] = s, dir[n++] = 0;
+            slot[n] = s, dir[n++] = 1;
+            slot[n] = &nt->rs, dir[n++] = 1;
+            slot[n] = &nt->ls, dir[n++] = 0;
         }
     }
-    bool flag;
-    Node* insert(Node* const pos, value_type* const v) {
-        if(equal(pos->v, v)) {
-            delete v;
-            flag = 0;
-            return pos;
+    void fixChain(Node* pos, bool right, bool grow) { // the right (or left) side of pos grew or shrank by one node.
+        while(pos) {
+            Node* const fa = pos->fa;
+            const bool side = fa && pos == fa->rs;
+            pos->maintain();
+            fix(fa == nullptr ? root : side ? fa->rs : fa->ls, right == grow);
+            right = side, pos = fa;
         }
-        Node* ret;
-        if(cmp(pos->v, v)) {
-            if(pos->rs) ret = insert(pos->rs, v);
-            else {
-                ret =  pos->rs = new Node(v);
-                pos->rs->fa = pos;
+    }
+    pair<iterator, bool> insert(value_type* const v) { // top-down, the fa links serve as the path back.
+        Node* cur = root;
+        while(1) {
+            if(equal(cur->v, v)) {
+                delete v;
+                return pair<iterator, bool>(iterator(this, cur), 0);
             }
-        } else {
-            if(pos->ls) ret = insert(pos->ls, v);
-            else {
-                ret = pos->ls = new Node(v);
-                pos->ls->fa = pos;
+            const bool right = cmp(cur->v, v);
+            Node*& next = right ? cur->rs : cur->ls;
+            if(next == nullptr) {
+                Node* const ret = next = new Node(v);
+                ret->fa = cur;
+                fixChain(cur, right, 1);
+                return pair<iterator, bool>(iterator(this, ret), 1);
             }
-        }
-        pos->maintain();
-        maintain(pos);
-        return ret;
-    }
-    pair<iterator, bool> insert(value_type* const v) {
-        flag = 1;
-        return pair<iterator, bool>(iterator(this, insert(root, v)), flag);
-    }
-    void fixChain(Node* pos) {
-        while(pos) {
-            pos->maintain();
-            pos = pos->fa;
+            cur = next;
         }
     }
     void erase(Node* pos) {
-        if(pos->ls == nullptr && pos->rs == nullptr) {
-            if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = nullptr;
-            fixChain(pos->fa);
-            delete pos;
-        } else {
-            if(pos->ls == nullptr || pos->rs == nullptr) {
-                Node* son = pos->ls ? pos->ls : pos->rs;
+        if(pos->ls && pos->rs) { // trade places with the predecessor, then pos has at most one child.
+            Node *son = pos->ls;
+            while (son->rs) son = son->rs;
+            if(son->fa != pos) {
+                if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = son;
+                else root = son;
+                (son == son->fa->ls ? son->fa->ls : son->fa->rs) = pos;
+                std::swap(pos->ls, son->ls), std::swap(pos->rs, son->rs), std::swap(pos->fa, son->fa);
+                if(pos->ls) pos->ls->fa = pos; if(pos->rs) pos->rs->fa = pos;
+                if(son->ls) son->ls->fa = son; if(son->rs) son->rs->fa = son;
+            } else {
                 if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = son, son->fa = pos->fa;
                 else root = son, son->fa = nullptr;
-                fixChain(pos->fa);
-                delete pos;
-            } else {
-                Node *son = pos->ls;
-                while (son->rs) son = son->rs;
-                if(son->fa != pos) {
-                    if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = son;
-                    else root = son;
-                    (son == son->fa->ls ? son->fa->ls : son->fa->rs) = pos;
-                    std::swap(pos->ls, son->ls), std::swap(pos->rs, son->rs), std::swap(pos->fa, son->fa);
-                    if(pos->ls) pos->ls->fa = pos; if(pos->rs) pos->rs->fa = pos;
-                    if(son->ls) son->ls->fa = son; if(son->rs) son->rs->fa = son;
-                } else {
-                    if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = son, son->fa = pos->fa;
-                    else root = son, son->fa = nullptr;
-                    const auto son_ls = son->ls, son_rs = son->rs;
-                    (son == pos->ls ? son->ls : son->rs) = pos, pos->fa = son;
-                    if((pos == son->ls ? (son->rs = pos->rs) : (son->ls = pos->ls))) (pos == son->ls ? son->rs : son->ls)->fa = son;
-                    if((pos->ls = son_ls)) pos->ls->fa = pos;
-                    if((pos->rs = son_rs)) pos->rs->fa = pos;
-                }
-                erase(pos);
+                const auto son_ls = son->ls, son_rs = son->rs;
+                (son == pos->ls ? son->ls : son->rs) = pos, pos->fa = son;
+                if((pos == son->ls ? (son->rs = pos->rs) : (son->ls = pos->ls))) (pos == son->ls ? son->rs : son->ls)->fa = son;
+                if((pos->ls = son_ls)) pos->ls->fa = pos;
+                if((pos->rs = son_rs)) pos->rs->fa = pos;
             }
         }
+        Node* const son = pos->ls ? pos->ls : pos->rs;
+        Node* const fa = pos->fa;
+        const bool right = fa && pos == fa->rs;
+        if(son) son->fa = fa;
+        if(fa) (right ? fa->rs : fa->ls) = son;
+        else root = son;
+        delete pos;
+        fixChain(fa, right, 0);
     }
     Node* find(const Key* tar) const {
         Node* cur = root;
@@ -254,6 +211,24 @@ private:
         return ret;
     }
 
+    Node* kth(size_t k) const { // the k-th node in order, the end node when k is too large.
+        Node* cur = root;
+        if(k >= size_t(cur->siz)) k = cur->siz - 1;
+        while(1) {
+            const size_t l = siz(cur->ls);
+            if(k == l) return cur;
+            if(k < l) cur = cur->ls;
+            else k -= l + 1, cur = cur->rs;
+        }
+    }
+    size_t rank(const Key* tar) const { // number of keys less than tar.
+        size_t ret = 0;
+        for(Node* cur = root; cur; )
+            if(cmp(cur->v, tar)) ret += siz(cur->ls) + 1, cur = cur->rs;
+            else cur = cur->ls;
+        return ret;
+    }
+
     Node* nodeBegin() const {
         Node* cur = root;
         while(cur->ls) cur = cur->ls;
@@ -271,10 +246,10 @@ public:
             Node* tar;
             iterator(map* _bel = nullptr, Node* _tar = nullptr): bel(_bel), tar(_tar) {}
             iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -289,10 +264,10 @@ public:
 			const_iterator(const map* _bel = nullptr, const Node* _tar = nullptr): bel(_bel), tar(_tar) {}
 			const_iterator(const const_iterator &other):bel(other.bel), tar(other.tar) {}
 			const_iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             const value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -304,8 +279,8 @@ public:
 	map(const map &other) { root = copyAll(other.root); }
 	map & operator=(const map &other) { if(this !=&other) deleteAll(root), root = copyAll(other.root); return *this; }
 	~map() { deleteAll(root); }
-	T & at(const Key &key) { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
-	const T & at(const Key &key) const { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
+	T & at(const Key &key) { Node* tar = find(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
+	const T & at(const Key &key) const { Node* tar = find(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
 	T & operator[](const Key &key) {
 	    Node* tar = find(&key);
 	    if(tar == nullptr) {
@@ -314,6 +289,14 @@ public:
         }
 	    return tar->v->second;
 	}
+	T & operator[](Key &&key) { // a new element takes the key over.
+	    Node* tar = find(&key);
+	    if(tar == nullptr) {
+	        value_type* nv = new value_type(std::move(key), T());
+	        tar = insert(nv).first.tar;
+        }
+	    return tar->v->second;
+	}
 	const T & operator[](const Key &key) const { return  at(key); }
 	iterator begin() { return iterator(this, nodeBegin()); }
 	const_iterator cbegin() const { return const_iterator(this, nodeBegin()); }
@@ -323,10 +306,14 @@ public:
 	size_t size() const { return root->siz - 1; }
 	void clear() { deleteAll(root), root = new Node(); }
 	pair<iterator, bool> insert(const value_type &value) { value_type* nv = new value_type(value); return insert(nv); }
-	void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) throw invalid_iterator(); else erase(pos.tar); }
+	pair<iterator, bool> insert(value_type &&value) { value_type* nv = new value_type(std::move(value)); return insert(nv); } // the value is moved, the const key copied.
+	void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) SJTU_THROW(invalid_iterator()); else erase(pos.tar); }
 	size_t count(const Key &key) const { auto tar = find(&key); return tar != nullptr; }
 	iterator find(const Key &key) { auto tar = find(&key); return tar == nullptr ? end() : iterator(this, tar); }
 	const_iterator find(const Key &key) const { auto tar = find(&key); return tar == nullptr ? cend() : const_iterator(this, tar); }
+	iterator select(size_t k) { return iterator(this, kth(k)); } // the k-th smallest, counted from 0, end() if k >= size().
+	const_iterator select(size_t k) const { return const_iterator(this, kth(k)); }
+	size_t rank(const Key &key) const { return rank(&key); } // number of keys less than key.
 };
 
 }
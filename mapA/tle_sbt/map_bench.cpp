@@ -0,0 +1,65 @@
+/**
+ * throughput of the size balanced tree map against std::map.
+ * usage: map_bench [keys] [repeats]
+ * each phase runs on the map the previous one left: sequential inserts, random inserts, random finds, then erasing
+ * half of the keys. every phase is repeated and the fastest run is kept, both maps see the same keys.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <map>
+#include <vector>
+#include "map.hpp"
+
+namespace {
+
+enum Phase { SEQUENTIAL, RANDOM, FIND, ERASE, PHASES };
+const char* const NAME[] = {"sequential insert", "random insert", "random find", "erase half"};
+
+std::vector<int> keys(long long n, unsigned seed) {
+    std::vector<int> ret(n);
+    for(int &k : ret) seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5, k = int(seed >> 1);
+    return ret;
+}
+
+template<class Map>
+void runPhase(Map &m, Phase p, const std::vector<int> &random, long long n, long long &sink) {
+    if(p == SEQUENTIAL) for(long long i = 0; i < n; i++) m[-int(i) - 1] = 0; // negative, so the random keys never collide.
+    else if(p == RANDOM) for(int k : random) m[k] = 0;
+    else if(p == FIND) for(int k : random) sink += m.count(k);
+    else for(long long i = 0; i < n; i += 2) m.erase(m.find(-int(i) - 1));
+}
+
+template<class Map>
+void run(double (&best)[PHASES], const std::vector<int> &random, long long n, long long &sink) {
+    Map m;
+    for(int p = SEQUENTIAL; p < PHASES; p++) {
+        const auto start = std::chrono::steady_clock::now();
+        runPhase(m, Phase(p), random, n, sink);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(best[p] == 0 || ms < best[p]) best[p] = ms;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long long n = argc > 1 ? atoll(argv[1]) : 1000000;
+    const int repeats = argc > 2 ? atoi(argv[2]) : 5;
+    const std::vector<int> random = keys(n, 2333);
+    double sbt[PHASES] = {}, stl[PHASES] = {};
+    long long sink = 0;
+    for(int r = 0; r < repeats; r++) {
+        run<sjtu::map<int, int> >(sbt, random, n, sink);
+        run<std::map<int, int> >(stl, random, n, sink);
+    }
+    printf("%lld keys, best of %d, found %lld\n", n, repeats, sink / repeats / 2);
+    printf("%18s %12s %12s\n", "ms", "sjtu::map", "std::map");
+    double totalSbt = 0, totalStl = 0;
+    for(int p = SEQUENTIAL; p < PHASES; p++) {
+        printf("%18s %12.1f %12.1f\n", NAME[p], sbt[p], stl[p]);
+        totalSbt += sbt[p], totalStl += stl[p];
+    }
+    printf("%18s %12.1f %12.1f\n", "total", totalSbt, totalStl);
+    return 0;
+}
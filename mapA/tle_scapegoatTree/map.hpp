@@ -12,7 +12,9 @@
 
 namespace sjtu {
 
-constexpr double ALPHA = 0.73;
+constexpr double ALPHA = 0.73; // default balance factor, each map may pick its own.
+constexpr int JOB_CAP = 128; // pending subtrees kept by the incremental rebuild, about the height of the tree.
+constexpr size_t STEP_LOG = 4; // an incremental update spends at least STEP_LOG * log2(size) steps.
 
 template<class Key, class T, class Compare = std::less<Key> >
 class map {
@@ -47,87 +49,198 @@ private:
          void maintain() { siz = (ls ? ls->siz : 0) + (rs ? rs->siz : 0) + 1; }
          void reset() { ls = rs = fa = nullptr, siz = 1; }
     }*root;
-    void dfs(Node** const dst, int& cnt, Node* const x) {
-        if(x->ls) dfs(dst, cnt, x->ls);
-        dst[++cnt] = x;
-        if(x->rs) dfs(dst, cnt, x->rs);
-        x->reset();
+    double alpha; // a child heavier than alpha * siz makes its parent a scapegoat.
+    Node *fail, *near; // the topmost scapegoat found by the last update, and the topmost one cheap enough to rebuild at once.
+
+    // incremental rebuild: instead of rebuilding a big scapegoat at once, every update spends quota() steps
+    // on it. A subtree is balanced by rotating its median up to its root, then its two halves are queued.
+    // Rotations keep the tree a valid search tree all along, so lookups and iterators never notice the work.
+    size_t budget; // 0 rebuilds eagerly.
+    size_t quota() const { // the work pending rebuilds need to keep up with updates grows with log(size).
+        size_t lg = 0;
+        for(int n = root ? root->siz : 0; n; n >>= 1) ++lg;
+        return budget > STEP_LOG * lg ? budget : STEP_LOG * lg;
     }
-    Node* rebuild(Node** const src, const int l, const int r) {
-        const int mid = (l + r) >> 1;
-        Node* ret = src[mid];
-        if(l < mid) ret->ls = rebuild(src, l, mid - 1), ret->ls->fa = ret;
-        if(mid < r) ret->rs = rebuild(src, mid + 1, r), ret->rs->fa = ret;
-        ret->maintain();
-        return ret;
+    // the job in hand is active: first cur walks down to its median, rank is the median's rank below cur, then
+    // med is rotated up until it takes active's place. Every level walked and every rotation is one step.
+    // While a job is in hand no other rebuild runs, so active stays an ancestor of cur and of med.
+    Node* job[JOB_CAP]; // subtrees waiting to be balanced.
+    int jobs;
+    Node *active, *cur, *med;
+    int rank;
+    void rotate(Node* pos) {
+        Node* const fa = pos->fa;
+        if(fa->fa) (fa == fa->fa->ls ? fa->fa->ls : fa->fa->rs) = pos, pos->fa = fa->fa;
+        else root = pos, pos->fa = nullptr;
+        if(pos == fa->ls) {
+            fa->ls = pos->rs;
+            if(fa->ls) fa->ls->fa = fa;
+            pos->rs = fa, fa->fa = pos;
+        } else {
+            fa->rs = pos->ls;
+            if(fa->rs) fa->rs->fa = fa;
+            pos->ls = fa, fa->fa = pos;
+        }
+        fa->maintain(), pos->maintain();
+    }
+    void resetJobs() { jobs = 0, active = cur = med = nullptr, rank = 0; }
+    void pushJob(Node* const x) {
+        if(x == nullptr || x->siz <= 2 || jobs == JOB_CAP || x == active) return; // tiny ones are balanced already.
+        for(int i = 0; i < jobs; i++) if(job[i] == x) return;
+        job[jobs++] = x;
+    }
+    void restartJob() { // the job in hand lost track of its nodes, it goes back to the queue.
+        Node* const x = active;
+        active = cur = med = nullptr, pushJob(x);
     }
-    Node *fail, *fail_fa;
-    void checkFail(Node* x) {
-        while(x) {
-            if(x->ls && x->ls->siz > x->siz * ALPHA) fail_fa = x->fa, fail = x;
-            if(x->rs && x->rs->siz > x->siz * ALPHA) fail_fa = x->fa, fail = x;
-            x = x->fa;
+    void scapegoat() { // deal with the scapegoats found by the last update.
+        if(fail == nullptr) return;
+        if(active == nullptr && (budget == 0 || size_t(fail->siz) <= quota())) { rebuild(fail); return; }
+        pushJob(fail);
+        if(near == nullptr || near == fail) return;
+        if(active) pushJob(near); // a rebuild now could move the nodes the job in hand is working on.
+        else rebuild(near); // cheap, and keeps the imbalance local while the big one is pending.
+    }
+    void advance(size_t steps) { // spend up to steps on the pending rebuilds, a rebuild of n nodes costs n.
+        while(steps) {
+            if(med) {
+                Node* const fa = med->fa;
+                if(fa == nullptr) { active = med = nullptr; continue; }
+                rotate(med), --steps;
+                if(fa == active) pushJob(med->rs), pushJob(med->ls), active = med = nullptr;
+                continue;
+            }
+            if(cur) {
+                if(rank >= cur->siz) rank = cur->siz - 1; // erases may have shrunk it meanwhile.
+                const int l = cur->ls ? cur->ls->siz : 0;
+                --steps;
+                if(rank == l) {
+                    if(cur == active) pushJob(active->rs), pushJob(active->ls), active = nullptr;
+                    else med = cur;
+                    cur = nullptr;
+                } else if(rank < l) cur = cur->ls;
+                else rank -= l + 1, cur = cur->rs;
+                continue;
+            }
+            if(jobs == 0) return;
+            Node* const x = job[--jobs];
+            if(size_t(x->siz) <= steps) { steps -= x->siz, rebuild(x); continue; }
+            active = cur = x, rank = (x->siz - 1) / 2;
         }
     }
-
-    void checkRebuild(Node* const cur) {
-        fail = fail_fa = nullptr, checkFail(cur);
-        if(fail) {
-            Node** temp = new Node* [fail->siz + 3];
-            int cnt = 0;
-            dfs(temp, cnt, fail);
-            auto t = (fail_fa == nullptr ? root : (fail == fail_fa->ls ? fail_fa->ls : fail_fa->rs)) = rebuild(temp, 1, cnt);
-            t->fa = fail_fa; // !
-            delete[] temp;
+    void forget(Node* const pos) { // pos is about to be freed.
+        if(jobs == 0 && active == nullptr) return;
+        if(pos == active) active = cur = med = nullptr;
+        else if(pos == cur || pos == med) restartJob();
+        for(int i = 0; i < jobs; i++) if(job[i] == pos) job[i--] = job[--jobs];
+    }
+    void compress(Node* scanner, int cnt) { // left-rotate every second node of the vine hanging on scanner->rs.
+        while(cnt--) {
+            Node* const child = scanner->rs;
+            scanner->rs = child->rs, scanner->rs->fa = scanner;
+            scanner = scanner->rs;
+            child->rs = scanner->ls;
+            if(child->rs) child->rs->fa = child;
+            scanner->ls = child, child->fa = scanner;
+            child->maintain(), scanner->maintain();
+        }
+    }
+    void rebuild(Node* const x) { // Day-Stout-Warren in place: flatten into a vine, then fold it back, no scratch buffer.
+        Node* const fa = x->fa;
+        Node*& link = fa == nullptr ? root : (x == fa->ls ? fa->ls : fa->rs);
+        const int n = x->siz;
+        Node dummy;
+        dummy.rs = x, x->fa = &dummy;
+        Node *tail = &dummy, *rest = x;
+        int cnt = n;
+        while(rest) {
+            if(rest->ls == nullptr) rest->siz = cnt--, tail = rest, rest = rest->rs; // sizes along a vine are just the counts left.
+            else {
+                Node* const l = rest->ls;
+                rest->ls = l->rs;
+                if(rest->ls) rest->ls->fa = rest;
+                l->rs = rest, rest->fa = l;
+                tail->rs = l, l->fa = tail;
+                rest = l;
+            }
+        }
+        int full = 1;
+        while(full * 2 <= n + 1) full <<= 1;
+        const int m = full - 1, leaves = n + 1 - full;
+        Node* scanner = &dummy;
+        for(int i = 0; i < m; ++i) { // spread the extra leaves evenly, so every node ends up split as evenly as a median split.
+            if(1LL * (i + 1) * leaves / m > 1LL * i * leaves / m) compress(scanner, 1);
+            scanner = scanner->rs;
         }
+        for(int k = m; k > 1; ) k >>= 1, compress(&dummy, k);
+        link = dummy.rs, link->fa = fa;
+        dummy.rs = nullptr;
     }
-    pair<iterator, bool> insert(value_type* const v) {
+    pair<iterator, bool> insert(value_type* const v) { // sizes are bumped and the scapegoat is picked on the way down.
         Node* cur = root;
+        fail = near = nullptr;
         while(1) {
             if(equal(cur->v, v)) {
                 delete v;
-                return pair<iterator, bool>(iterator(this, cur), 0); // todo: return an iterator.
+                for(Node* pos = cur->fa; pos; pos = pos->fa) --pos->siz;
+                return pair<iterator, bool>(iterator(this, cur), 0);
             }
+            ++cur->siz;
             if(cmp(cur->v, v)) {
+                if((cur->rs ? cur->rs->siz : 0) + 1 > cur->siz * alpha) mark(cur);
                 if(cur->rs) cur = cur->rs;
                 else {
                     cur->rs = new Node(v), cur->rs->fa = cur;
-                    cur->maintain(), cur = cur->rs;
+                    cur = cur->rs;
                     break;
                 }
             } else {
+                if((cur->ls ? cur->ls->siz : 0) + 1 > cur->siz * alpha) mark(cur);
                 if(cur->ls) cur = cur->ls;
                 else {
                     cur->ls = new Node(v), cur->ls->fa = cur;
-                    cur->maintain(), cur = cur->ls;
+                    cur = cur->ls;
                     break;
                 }
             }
         }
-        fixChain(cur), checkRebuild(cur);
+        scapegoat();
+        advance(quota());
         return pair<iterator, bool>(iterator(this, cur), 1);
     }
-    void fixChain(Node* pos) {
+    void mark(Node* const pos) { // called from top to bottom.
+        if(fail == nullptr) fail = pos;
+        if(near == nullptr && size_t(pos->siz) <= quota()) near = pos;
+    }
+    void fixChain(Node* pos) { // also picks the scapegoats on the way up.
+        fail = near = nullptr;
         while(pos) {
             pos->maintain();
+            if((pos->ls && pos->ls->siz > pos->siz * alpha) || (pos->rs && pos->rs->siz > pos->siz * alpha)) {
+                fail = pos;
+                if(size_t(pos->siz) <= quota()) near = pos;
+            }
             pos = pos->fa;
         }
     }
     void erase(Node* pos) {
         if(pos->ls == nullptr && pos->rs == nullptr) {
             if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = nullptr;
-            fixChain(pos->fa), checkRebuild(pos->fa);
-            delete pos;
+            fixChain(pos->fa);
+            forget(pos), delete pos;
+            scapegoat();
         } else {
             if(pos->ls == nullptr || pos->rs == nullptr) {
                 Node* son = pos->ls ? pos->ls : pos->rs;
                 if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = son, son->fa = pos->fa;
                 else root = son, son->fa = nullptr;
-                fixChain(pos->fa), checkRebuild(pos->fa);
-                delete pos;
+                fixChain(pos->fa);
+                forget(pos), delete pos;
+                scapegoat();
             } else {
                 Node *son = pos->ls;
                 while (son->rs) son = son->rs;
+                if(active && (son == cur || son == med || pos == cur)) restartJob(); // they are about to swap places.
                 if(son->fa != pos) {
                     if(pos->fa) (pos == pos->fa->ls ? pos->fa->ls : pos->fa->rs) = son;
                     else root = son;
@@ -229,10 +342,10 @@ public:
             Node* tar;
             iterator(map* _bel = nullptr, Node* _tar = nullptr): bel(_bel), tar(_tar) {}
             iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -247,10 +360,10 @@ public:
 			const_iterator(const map* _bel = nullptr, const Node* _tar = nullptr): bel(_bel), tar(_tar) {}
 			const_iterator(const const_iterator &other):bel(other.bel), tar(other.tar) {}
 			const_iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             const value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -258,12 +371,17 @@ public:
             bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
             const value_type* operator->() const noexcept { return tar->v; }
 	};
-	map() { root = new Node(); }
-	map(const map &other) { root = copyAll(other.root); }
-	map & operator=(const map &other) { if(this !=&other) deleteAll(root), root = copyAll(other.root); return *this; }
+	map(): alpha(ALPHA), budget(0) { root = new Node(), resetJobs(); }
+	explicit map(double _alpha, size_t _budget = 0): alpha(_alpha), budget(_budget) { root = new Node(), resetJobs(); }
+	map(const map &other): alpha(other.alpha), budget(other.budget) { root = copyAll(other.root), resetJobs(); }
+	map & operator=(const map &other) { if(this !=&other) deleteAll(root), alpha = other.alpha, budget = other.budget, root = copyAll(other.root), resetJobs(); return *this; }
+	void set_rebuild_budget(size_t _budget) { // steps per update spent on big rebuilds, 0 means rebuilding at once.
+	    budget = _budget;
+	    if(budget == 0) while(jobs || active) advance(size());
+	}
 	~map() { deleteAll(root); }
-	T & at(const Key &key) { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
-	const T & at(const Key &key) const { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
+	T & at(const Key &key) { Node* tar = find(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
+	const T & at(const Key &key) const { Node* tar = find(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
 	T & operator[](const Key &key) {
 	    Node* tar = find(&key);
 	    if(tar == nullptr) {
@@ -272,6 +390,14 @@ public:
         }
 	    return tar->v->second;
 	}
+	T & operator[](Key &&key) { // a new element takes the key over.
+	    Node* tar = find(&key);
+	    if(tar == nullptr) {
+	        value_type* nv = new value_type(std::move(key), T());
+	        tar = insert(nv).first.tar;
+        }
+	    return tar->v->second;
+	}
 	const T & operator[](const Key &key) const { return  at(key); }
 	iterator begin() { return iterator(this, nodeBegin()); }
 	const_iterator cbegin() const { return const_iterator(this, nodeBegin()); }
@@ -279,9 +405,10 @@ public:
 	const_iterator cend() const { return const_iterator(this, nodeEnd()); }
 	bool empty() const { return size() == 0; }
 	size_t size() const { return root->siz - 1; }
-	void clear() { deleteAll(root), root = new Node(); }
+	void clear() { deleteAll(root), root = new Node(), resetJobs(); }
 	pair<iterator, bool> insert(const value_type &value) { value_type* nv = new value_type(value); return insert(nv); }
-	void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) throw invalid_iterator(); else erase(pos.tar); }
+	pair<iterator, bool> insert(value_type &&value) { value_type* nv = new value_type(std::move(value)); return insert(nv); } // the value is moved, the const key copied.
+	void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) SJTU_THROW(invalid_iterator()); else erase(pos.tar), advance(quota()); }
 	size_t count(const Key &key) const { auto tar = find(&key); return tar != nullptr; }
 	iterator find(const Key &key) { auto tar = find(&key); return tar == nullptr ? end() : iterator(this, tar); }
 	const_iterator find(const Key &key) const { auto tar = find(&key); return tar == nullptr ? cend() : const_iterator(this, tar); }
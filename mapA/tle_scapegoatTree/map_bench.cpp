@@ -0,0 +1,87 @@
+/**
+ * latency of single updates on the scapegoat map, eager rebuilds against incremental ones.
+ * usage: map_bench [operations] [budget...]
+ * with no budgets it runs 0 (eager), 1 and 32. every update is timed on its own and counted in a histogram of
+ * power of two buckets; the tail buckets are where the eager rebuilds of big subtrees show up.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "map.hpp"
+
+namespace {
+
+constexpr int BUCKETS = 24; // bucket i counts updates that took [2^(i-1), 2^i) * 64 ns, the last one everything above.
+constexpr double UNIT = 0.064; // microseconds.
+
+enum Workload { SEQUENTIAL, ZIGZAG, RANDOM };
+const char* const NAME[] = {"sequential insert", "zigzag insert", "random insert/erase"};
+
+struct Histogram {
+    long long count[BUCKETS] = {};
+    double worst = 0, total = 0;
+    void add(double us) {
+        int b = 0;
+        for(double lim = UNIT; us >= lim && b + 1 < BUCKETS; lim *= 2) ++b;
+        ++count[b], total += us;
+        if(us > worst) worst = us;
+    }
+    double quantile(double q, long long n) const { // the upper end of the bucket holding the q-th update.
+        long long seen = 0;
+        double lim = UNIT;
+        for(int b = 0; b < BUCKETS; b++, lim *= 2) if((seen += count[b]) >= q * n) return lim;
+        return worst;
+    }
+};
+
+Histogram run(Workload w, size_t budget, long long n) {
+    sjtu::map<int, int> m(sjtu::ALPHA, budget);
+    Histogram h;
+    unsigned x = 2333;
+    for(long long i = 0; i < n; i++) {
+        x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+        const auto start = std::chrono::steady_clock::now();
+        if(w == SEQUENTIAL) m[int(i)] = 0;
+        else if(w == ZIGZAG) m[int(i % 2 ? i : -i)] = 0;
+        else if(x % 3 || m.empty()) m[int(x >> 1)] = 0;
+        else m.erase(m.begin()); // always from the left, which unbalances the tree quickest.
+        h.add(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return h;
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long long n = argc > 1 ? atoll(argv[1]) : 2000000;
+    std::vector<size_t> budgets;
+    for(int i = 2; i < argc; i++) budgets.push_back(atol(argv[i]));
+    if(budgets.empty()) budgets = {0, 1, 32};
+    for(int w = SEQUENTIAL; w <= RANDOM; w++) {
+        printf("%s, %lld updates\n", NAME[w], n);
+        std::vector<Histogram> hs;
+        for(size_t b : budgets) hs.push_back(run(Workload(w), b, n));
+        printf("%14s", "us below");
+        for(size_t b : budgets) printf(" %11s%-3zu", "budget ", b);
+        printf("\n");
+        double lim = UNIT;
+        for(int k = 0; k < BUCKETS; k++, lim *= 2) {
+            bool any = false;
+            for(const Histogram &h : hs) any |= h.count[k] != 0;
+            if(!any) continue;
+            if(k + 1 < BUCKETS) printf("%14.3f", lim);
+            else printf("%14s", "more");
+            for(const Histogram &h : hs) printf(" %14lld", h.count[k]);
+            printf("\n");
+        }
+        printf("%14s", "p99.9 us");
+        for(const Histogram &h : hs) printf(" %14.3f", h.quantile(0.999, n));
+        printf("\n%14s", "worst us");
+        for(const Histogram &h : hs) printf(" %14.1f", h.worst);
+        printf("\n%14s", "mean us");
+        for(const Histogram &h : hs) printf(" %14.3f", h.total / n);
+        printf("\n\n");
+    }
+    return 0;
+}
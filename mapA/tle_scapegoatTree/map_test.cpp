@@ -0,0 +1,92 @@
+/**
+ * the scapegoat map against std::map with eager and incremental rebuilds, then the copies made by the rvalue insert
+ * paths.
+ * usage: map_test [operations] [seed]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include "map.hpp"
+
+namespace {
+
+struct Counted { // counts the copies of every instance, moves are free.
+    static long copies;
+    int v;
+    Counted(int _v = 0): v(_v) {}
+    Counted(const Counted &other): v(other.v) { ++copies; }
+    Counted(Counted &&other): v(other.v) {}
+    Counted & operator=(const Counted &other) { v = other.v, ++copies; return *this; }
+    Counted & operator=(Counted &&other) { v = other.v; return *this; }
+    bool operator<(const Counted &rhs) const { return v < rhs.v; }
+};
+long Counted::copies = 0;
+
+int failures = 0;
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+template<class Map>
+void same(const Map &m, const std::map<int, int> &ref, long step) { // every element in order, both ways.
+    EXPECT(m.size() == ref.size());
+    auto it = m.cbegin();
+    for(const auto &p : ref) {
+        EXPECT(it != m.cend() && it->first == p.first && it->second == p.second);
+        ++it;
+    }
+    EXPECT(it == m.cend());
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) EXPECT((--it)->first == r->first);
+}
+
+void fuzz(long n, unsigned seed, int range, size_t budget) {
+    sjtu::map<int, int> m(sjtu::ALPHA, budget);
+    std::map<int, int> ref;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 7;
+        if(op == 0) EXPECT(m.insert(sjtu::pair<const int, int>(key, int(step))).second == ref.insert(std::make_pair(key, int(step))).second);
+        else if(op == 1) { int k = key; m[std::move(k)] = int(step), ref[key] = int(step); }
+        else if(op == 2) m[key] += 1, ref[key] += 1;
+        else if(op == 3 || op == 4) {
+            const auto it = m.find(key);
+            EXPECT((it == m.end()) == !ref.count(key));
+            if(it != m.end()) m.erase(it), ref.erase(key);
+        } else if(op == 5) {
+            bool thrown = false;
+            try { const int v = m.at(key); EXPECT(ref.count(key) && ref.at(key) == v); } catch(sjtu::index_out_of_bound &) { thrown = true; }
+            EXPECT(thrown == !ref.count(key));
+        } else EXPECT(m.count(key) == ref.count(key));
+        if(step % 16384 == 0) { // copies stay apart from the original.
+            sjtu::map<int, int> copy(m), assigned;
+            assigned = m;
+            std::map<int, int> changed(ref);
+            copy[key] = changed[key] = -1;
+            same(assigned, ref, step), assigned.clear();
+            same(m, ref, step), same(copy, changed, step);
+        } else if(step % 4096 == 0) same(m, ref, step);
+        if(failures) return;
+    }
+    same(m, ref, n);
+}
+
+void copies() { // the rvalue paths move the mapped value and the key handed to operator[].
+    long step = 0;
+    sjtu::map<int, Counted> values;
+    sjtu::map<Counted, int> keys;
+    Counted::copies = 0;
+    for(int i = 0; i < 100; i++) values.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+    for(int i = 0; i < 100; i++) keys[Counted(i)] = i;
+    EXPECT(Counted::copies == 0 && values.size() == 100 && keys.size() == 100);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 200000;
+    const unsigned seed = argc > 2 ? unsigned(atol(argv[2])) : 2333;
+    for(size_t budget : {0, 1, 32}) for(int range : {16, 1000, 1 << 30}) fuzz(n, seed + range, range, budget);
+    copies();
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
@@ -255,10 +255,10 @@ public:
             Node* tar;
             iterator(map* _bel = nullptr, Node* _tar = nullptr): bel(_bel), tar(_tar) {}
             iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -273,10 +273,10 @@ public:
 			const_iterator(const map* _bel = nullptr, const Node* _tar = nullptr): bel(_bel), tar(_tar) {}
 			const_iterator(const const_iterator &other):bel(other.bel), tar(other.tar) {}
 			const_iterator(const iterator &other):bel(other.bel), tar(other.tar) {}
-            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
-            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return ret; }
-            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) throw invalid_iterator(); else return *this; }
+            const_iterator operator++(int) { auto ret = *this; tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator++() { tar = bel->findNxt(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
+            const_iterator operator--(int) { auto ret = *this; tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return ret; }
+            const_iterator & operator--() { tar = bel->findPrv(tar); if(tar == nullptr) SJTU_THROW(invalid_iterator()); else return *this; }
             const value_type & operator*() const { return *tar->v; }
             bool operator==(const iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
             bool operator==(const const_iterator &rhs) const { return  bel == rhs.bel && tar == rhs.tar; }
@@ -288,8 +288,8 @@ public:
 	map(const map &other) { root = copyAll(other.root); }
 	map & operator=(const map &other) { if(this !=&other) deleteAll(root), root = copyAll(other.root); return *this; }
 	~map() { deleteAll(root); }
-	T & at(const Key &key) { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
-	const T & at(const Key &key) const { Node* tar = find(&key); if(tar == nullptr) throw index_out_of_bound(); return tar->v->second; }
+	T & at(const Key &key) { Node* tar = find(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
+	const T & at(const Key &key) const { Node* tar = find(&key); if(tar == nullptr) SJTU_THROW(index_out_of_bound("map::at")); return tar->v->second; }
 	T & operator[](const Key &key) {
 	    Node* tar = find(&key);
 	    if(tar == nullptr) {
@@ -307,7 +307,7 @@ public:
 	size_t size() const { return root->siz - 1; }
 	void clear() { deleteAll(root), root = mp.newNode(nullptr); }
 	pair<iterator, bool> insert(const value_type &value) { value_type* nv = new value_type(value); return insert(nv); }
-	void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) throw invalid_iterator(); else erase(pos.tar); }
+	void erase(iterator pos) { if(pos.bel != this || pos.tar->v == nullptr) SJTU_THROW(invalid_iterator()); else erase(pos.tar); }
 	size_t count(const Key &key) const { auto tar = find(&key); return tar != nullptr; }
 	iterator find(const Key &key) { auto tar = find(&key); return tar == nullptr ? end() : iterator(this, tar); }
 	const_iterator find(const Key &key) const { auto tar = find(&key); return tar == nullptr ? cend() : const_iterator(this, tar); }
@@ -1,25 +1,44 @@
 #ifndef SJTU_UTILITY_HPP
 #define SJTU_UTILITY_HPP
 
+#include <cstddef>
+#include <tuple>
 #include <utility>
 
 namespace sjtu {
 
+template<size_t... I>
+struct index_list {};
+template<size_t N, size_t... I>
+struct make_index_list : make_index_list<N - 1, N - 1, I...> {};
+template<size_t... I>
+struct make_index_list<0, I...> { typedef index_list<I...> type; };
+
 template<class T1, class T2>
 class pair {
+	template<class Tuple1, class Tuple2, size_t... I1, size_t... I2>
+	pair(Tuple1 &a, Tuple2 &b, index_list<I1...>, index_list<I2...>)
+		: first(std::forward<typename std::tuple_element<I1, Tuple1>::type>(std::get<I1>(a))...),
+		  second(std::forward<typename std::tuple_element<I2, Tuple2>::type>(std::get<I2>(b))...) {}
 public:
 	T1 first;
 	T2 second;
 	constexpr pair() : first(), second() {}
 	pair(const pair &other) = default;
 	pair(pair &&other) = default;
+	pair &operator=(const pair &other) = default;
+	pair &operator=(pair &&other) = default;
 	pair(const T1 &x, const T2 &y) : first(x), second(y) {}
 	template<class U1, class U2>
-	pair(U1 &&x, U2 &&y) : first(x), second(y) {}
+	pair(U1 &&x, U2 &&y) : first(std::forward<U1>(x)), second(std::forward<U2>(y)) {}
 	template<class U1, class U2>
 	pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
 	template<class U1, class U2>
-	pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
+	pair(pair<U1, U2> &&other) : first(std::forward<U1>(other.first)), second(std::forward<U2>(other.second)) {}
+	// first is built from the elements of a and second from those of b, in place: no copy or move of T1 or T2.
+	template<class... Args1, class... Args2>
+	pair(std::piecewise_construct_t, std::tuple<Args1...> a, std::tuple<Args2...> b)
+		: pair(a, b, typename make_index_list<sizeof...(Args1)>::type(), typename make_index_list<sizeof...(Args2)>::type()) {}
 };
 
 }
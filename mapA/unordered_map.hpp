@@ -0,0 +1,275 @@
+/**
+ * implement a container like std::unordered_map, as an open addressing swiss table.
+ * every slot has a control byte: empty, deleted, or the low 7 bits of its hash when full. a lookup compares the 7 bits
+ * against a whole group of control bytes at once, and only looks at the keys that match.
+ */
+#ifndef SJTU_UNORDERED_MAP_HPP
+#define SJTU_UNORDERED_MAP_HPP
+// only for std::hash<T> and std::equal_to<T>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SJTU_SWISS_SSE2 1
+#endif
+
+namespace sjtu {
+
+struct swiss_group { // the control bytes of one probe step.
+    typedef signed char ctrl_t;
+    static constexpr ctrl_t EMPTY = -128, DELETED = -2; // full ones are 0 ~ 127.
+#ifdef SJTU_SWISS_SSE2
+    static constexpr int WIDTH = 16, SHIFT = 0; // a mask has one bit per byte.
+    typedef uint32_t mask_t;
+    __m128i ctrl;
+    explicit swiss_group(const ctrl_t* pos): ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+    mask_t match(ctrl_t h) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), ctrl)); }
+    mask_t matchEmpty() const { return match(EMPTY); }
+    mask_t matchFree() const { return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl)); } // empty or deleted.
+    static int trailing(mask_t m) { return m ? __builtin_ctz(m) : WIDTH; }
+    static int leading(mask_t m) { return m ? __builtin_clz(m) - 16 : WIDTH; }
+#else
+    static constexpr int WIDTH = 8, SHIFT = 3; // plain 64 bit words, a mask has the top bit of each byte.
+    typedef uint64_t mask_t;
+    static constexpr uint64_t LSB = 0x0101010101010101ull, MSB = 0x8080808080808080ull;
+    uint64_t ctrl;
+    explicit swiss_group(const ctrl_t* pos) { std::memcpy(&ctrl, pos, sizeof(ctrl)); }
+    mask_t match(ctrl_t h) const { const uint64_t x = ctrl ^ (LSB * uint8_t(h)); return (x - LSB) & ~x & MSB; } // may report a byte right after a real match, keys are compared anyway.
+    mask_t matchEmpty() const { return ctrl & ~(ctrl << 6) & MSB; }
+    mask_t matchFree() const { return ctrl & ~(ctrl << 7) & MSB; }
+    static int trailing(mask_t m) { return m ? __builtin_ctzll(m) >> 3 : WIDTH; }
+    static int leading(mask_t m) { return m ? __builtin_clzll(m) >> 3 : WIDTH; }
+#endif
+    static int lowest(mask_t m) { return (SHIFT ? __builtin_ctzll(m) : __builtin_ctz(uint32_t(m))) >> SHIFT; }
+};
+
+template<class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key> >
+class unordered_map {
+public:
+    class iterator;
+    class const_iterator;
+    typedef pair<const Key, T> value_type;
+private:
+    typedef swiss_group group;
+    typedef group::ctrl_t ctrl_t;
+    static constexpr int WIDTH = group::WIDTH;
+
+    Hash hasher;
+    KeyEqual eq;
+    ctrl_t* ctrl; // cap bytes, then the first WIDTH of them again, so a group never wraps.
+    value_type* slot;
+    size_t cap, siz, growth; // growth: inserts left before the table must grow, deleted slots count as used.
+
+    static ctrl_t h2(size_t h) { return ctrl_t(h & 0x7f); }
+    size_t hash(const Key &key) const { // spread std::hash, which is the identity for integers.
+        uint64_t h = uint64_t(hasher(key)) * 0x9e3779b97f4a7c15ull;
+        return size_t(h ^ (h >> 29));
+    }
+    static size_t growthOf(size_t cap) { return cap - cap / 8; } // at most 7 / 8 full.
+    void setCtrl(size_t i, ctrl_t h) {
+        ctrl[i] = h;
+        if(i < size_t(WIDTH)) ctrl[cap + i] = h;
+    }
+    void init(size_t _cap) { // _cap: 0 or a power of two, at least WIDTH.
+        cap = _cap, siz = 0, growth = growthOf(cap);
+        if(cap == 0) { ctrl = nullptr, slot = nullptr; return; }
+        ctrl = new ctrl_t[cap + WIDTH];
+        std::memset(ctrl, group::EMPTY, cap + WIDTH);
+        slot = static_cast<value_type*>(::operator new(cap * sizeof(value_type)));
+    }
+    void destroy() {
+        for(size_t i = 0; i < cap; i++) if(ctrl[i] >= 0) slot[i].~value_type();
+        delete [] ctrl, ::operator delete(slot);
+    }
+    size_t findSlot(const Key &key, size_t h) const { // cap when absent.
+        if(cap == 0) return cap;
+        const size_t mask = cap - 1;
+        for(size_t pos = (h >> 7) & mask, step = 0; ; step += WIDTH, pos = (pos + step) & mask) { // triangular steps visit every group.
+            const group g(ctrl + pos);
+            for(typename group::mask_t m = g.match(h2(h)); m; m &= m - 1) {
+                const size_t i = (pos + group::lowest(m)) & mask;
+                if(eq(slot[i].first, key)) return i;
+            }
+            if(g.matchEmpty()) return cap;
+        }
+    }
+    size_t freeSlot(size_t h) const { // the first empty or deleted slot on the probe sequence of h.
+        const size_t mask = cap - 1;
+        for(size_t pos = (h >> 7) & mask, step = 0; ; step += WIDTH, pos = (pos + step) & mask) {
+            const typename group::mask_t m = group(ctrl + pos).matchFree();
+            if(m) return (pos + group::lowest(m)) & mask;
+        }
+    }
+    void rehash(size_t ncap) { // move every element into a table of ncap slots.
+        ctrl_t* const octrl = ctrl;
+        value_type* const oslot = slot;
+        const size_t ocap = cap, osiz = siz;
+        init(ncap);
+        for(size_t i = 0; i < ocap; i++) if(octrl[i] >= 0) {
+            const size_t h = hash(oslot[i].first), j = freeSlot(h);
+            new(slot + j) value_type(std::move(oslot[i]));
+            oslot[i].~value_type();
+            setCtrl(j, h2(h));
+        }
+        siz = osiz, growth -= siz;
+        delete [] octrl, ::operator delete(oslot);
+    }
+    void reserveOne() { // make room for one more insert.
+        if(growth) return;
+        if(cap == 0) rehash(WIDTH);
+        else if(siz * 32 <= cap * 25) rehash(cap); // mostly tombstones, squeeze them out in place of growing.
+        else rehash(cap * 2);
+    }
+    template<class... Args>
+    size_t place(size_t h, Args&&... args) { // put a new element of hash h, known to be absent.
+        reserveOne();
+        const size_t i = freeSlot(h);
+        new(slot + i) value_type(std::forward<Args>(args)...);
+        if(ctrl[i] == group::EMPTY) --growth;
+        setCtrl(i, h2(h)), ++siz;
+        return i;
+    }
+    template<class... Args>
+    pair<size_t, bool> insertSlot(const Key &key, Args&&... args) { // args build the value when key is absent.
+        const size_t h = hash(key), i = findSlot(key, h);
+        if(i != cap) return pair<size_t, bool>(i, 0);
+        return pair<size_t, bool>(place(h, std::forward<Args>(args)...), 1);
+    }
+    void eraseSlot(size_t i) {
+        const size_t mask = cap - 1;
+        slot[i].~value_type(), --siz;
+        // a probe only passes a group with no empty slot, if no such window covers i it may go back to empty.
+        const int before = group::leading(group(ctrl + ((i - WIDTH) & mask)).matchEmpty());
+        const int after = group::trailing(group(ctrl + i).matchEmpty());
+        if(before + after < WIDTH) setCtrl(i, group::EMPTY), ++growth;
+        else setCtrl(i, group::DELETED);
+    }
+    size_t nxt(size_t i) const { while(i < cap && ctrl[i] < 0) ++i; return i; } // the first full slot from i, cap if none.
+    size_t prv(size_t i) const { while(i-- > 0) if(ctrl[i] >= 0) return i; return cap; } // the last full slot before i, cap if none.
+    void copyAll(const unordered_map &other) {
+        init(other.cap);
+        if(cap == 0) return;
+        size_t i = 0;
+        SJTU_TRY {
+            for(; i < cap; i++) if(other.ctrl[i] >= 0) new(slot + i) value_type(other.slot[i]);
+        } SJTU_CATCH_ALL {
+            while(i-- > 0) if(other.ctrl[i] >= 0) slot[i].~value_type();
+            delete [] ctrl, ::operator delete(slot), init(0);
+            SJTU_RETHROW;
+        }
+        std::memcpy(ctrl, other.ctrl, cap + WIDTH);
+        siz = other.siz, growth = other.growth;
+    }
+public:
+    class iterator {
+        public:
+            unordered_map* bel;
+            size_t tar; // bel->cap is end().
+            iterator(unordered_map* _bel = nullptr, size_t _tar = 0): bel(_bel), tar(_tar) {}
+            iterator(const iterator &other): bel(other.bel), tar(other.tar) {}
+            iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+            iterator & operator++() { if(tar >= bel->cap) SJTU_THROW(invalid_iterator()); tar = bel->nxt(tar + 1); return *this; }
+            iterator operator--(int) { auto ret = *this; --*this; return ret; }
+            iterator & operator--() { const size_t p = bel->prv(tar); if(p == bel->cap) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+            value_type & operator*() const { return bel->slot[tar]; }
+            bool operator==(const iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+            value_type* operator->() const noexcept { return bel->slot + tar; }
+    };
+    class const_iterator {
+        public:
+            const unordered_map* bel;
+            size_t tar;
+            const_iterator(const unordered_map* _bel = nullptr, size_t _tar = 0): bel(_bel), tar(_tar) {}
+            const_iterator(const const_iterator &other): bel(other.bel), tar(other.tar) {}
+            const_iterator(const iterator &other): bel(other.bel), tar(other.tar) {}
+            const_iterator operator++(int) { auto ret = *this; ++*this; return ret; }
+            const_iterator & operator++() { if(tar >= bel->cap) SJTU_THROW(invalid_iterator()); tar = bel->nxt(tar + 1); return *this; }
+            const_iterator operator--(int) { auto ret = *this; --*this; return ret; }
+            const_iterator & operator--() { const size_t p = bel->prv(tar); if(p == bel->cap) SJTU_THROW(invalid_iterator()); tar = p; return *this; }
+            const value_type & operator*() const { return bel->slot[tar]; }
+            bool operator==(const iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator==(const const_iterator &rhs) const { return bel == rhs.bel && tar == rhs.tar; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+            const value_type* operator->() const noexcept { return bel->slot + tar; }
+    };
+
+    unordered_map() { init(0); }
+    explicit unordered_map(size_t n, const Hash &_hasher = Hash(), const KeyEqual &_eq = KeyEqual()): hasher(_hasher), eq(_eq) { init(0), reserve(n); }
+    unordered_map(const unordered_map &other): hasher(other.hasher), eq(other.eq) { copyAll(other); }
+    unordered_map(unordered_map &&other): hasher(other.hasher), eq(other.eq), ctrl(other.ctrl), slot(other.slot), cap(other.cap), siz(other.siz), growth(other.growth) { other.init(0); }
+    unordered_map & operator=(const unordered_map &other) {
+        if(this != &other) destroy(), init(0), hasher = other.hasher, eq = other.eq, copyAll(other);
+        return *this;
+    }
+    unordered_map & operator=(unordered_map &&other) {
+        if(this != &other) destroy(), hasher = other.hasher, eq = other.eq, ctrl = other.ctrl, slot = other.slot, cap = other.cap, siz = other.siz, growth = other.growth, other.init(0);
+        return *this;
+    }
+    ~unordered_map() { destroy(); }
+
+    T & at(const Key &key) { const size_t i = findSlot(key, hash(key)); if(i == cap) SJTU_THROW(index_out_of_bound("unordered_map::at")); return slot[i].second; }
+    const T & at(const Key &key) const { const size_t i = findSlot(key, hash(key)); if(i == cap) SJTU_THROW(index_out_of_bound("unordered_map::at")); return slot[i].second; }
+    T & operator[](const Key &key) {
+        const size_t h = hash(key);
+        size_t i = findSlot(key, h);
+        if(i == cap) i = place(h, key, T());
+        return slot[i].second;
+    }
+    T & operator[](Key &&key) { // a new element takes the key over.
+        const size_t h = hash(key);
+        size_t i = findSlot(key, h);
+        if(i == cap) i = place(h, std::move(key), T());
+        return slot[i].second;
+    }
+    const T & operator[](const Key &key) const { return at(key); }
+    iterator begin() { return iterator(this, nxt(0)); }
+    const_iterator cbegin() const { return const_iterator(this, nxt(0)); }
+    iterator end() { return iterator(this, cap); }
+    const_iterator cend() const { return const_iterator(this, cap); }
+    bool empty() const { return siz == 0; }
+    size_t size() const { return siz; }
+    size_t bucket_count() const { return cap; }
+    double load_factor() const { return cap ? double(siz) / cap : 0; }
+    void reserve(size_t n) { // room for n elements without growing.
+        size_t ncap = WIDTH;
+        while(growthOf(ncap) < n) ncap <<= 1;
+        if(ncap > cap) rehash(ncap);
+    }
+    void clear() {
+        for(size_t i = 0; i < cap; i++) if(ctrl[i] >= 0) slot[i].~value_type();
+        if(cap) std::memset(ctrl, group::EMPTY, cap + WIDTH);
+        siz = 0, growth = growthOf(cap);
+    }
+    pair<iterator, bool> insert(const value_type &value) {
+        const pair<size_t, bool> ret = insertSlot(value.first, value);
+        return pair<iterator, bool>(iterator(this, ret.first), ret.second);
+    }
+    pair<iterator, bool> insert(value_type &&value) { // the value is moved, the const key copied.
+        const pair<size_t, bool> ret = insertSlot(value.first, std::move(value));
+        return pair<iterator, bool>(iterator(this, ret.first), ret.second);
+    }
+    template<class... Args>
+    pair<iterator, bool> emplace(Args&&... args) { // the value is built first, to learn its key.
+        value_type v(std::forward<Args>(args)...);
+        const pair<size_t, bool> ret = insertSlot(v.first, std::move(v));
+        return pair<iterator, bool>(iterator(this, ret.first), ret.second);
+    }
+    void erase(iterator pos) { if(pos.bel != this || pos.tar >= cap || ctrl[pos.tar] < 0) SJTU_THROW(invalid_iterator()); else eraseSlot(pos.tar); }
+    size_t erase(const Key &key) { const size_t i = findSlot(key, hash(key)); if(i == cap) return 0; eraseSlot(i); return 1; }
+    size_t count(const Key &key) const { return findSlot(key, hash(key)) != cap; }
+    iterator find(const Key &key) { return iterator(this, findSlot(key, hash(key))); }
+    const_iterator find(const Key &key) const { return const_iterator(this, findSlot(key, hash(key))); }
+};
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ * the swiss table against std::unordered_map, with a good hash and with one that puts every key in a few groups,
+ * then the copies made by the rvalue insert paths.
+ * usage: unordered_map_test [operations] [seed]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include "unordered_map.hpp"
+
+namespace {
+
+struct Counted { // counts the copies of every instance, moves are free.
+    static long copies;
+    int v;
+    Counted(int _v = 0): v(_v) {}
+    Counted(const Counted &other): v(other.v) { ++copies; }
+    Counted(Counted &&other): v(other.v) {}
+    Counted & operator=(const Counted &other) { v = other.v, ++copies; return *this; }
+    Counted & operator=(Counted &&other) { v = other.v; return *this; }
+    bool operator==(const Counted &rhs) const { return v == rhs.v; }
+};
+long Counted::copies = 0;
+struct CountedHash {
+    size_t operator()(const Counted &x) const { return size_t(x.v); }
+};
+struct Crowded { // 16 hashes in all, so whole groups fill up and probes run long.
+    size_t operator()(int x) const { return size_t(x & 15); }
+};
+
+typedef std::unordered_map<int, std::string> Ref;
+
+int failures = 0;
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+template<class Map>
+void same(const Map &m, const Ref &ref, long step) { // every element once, forwards and backwards, within the load limit.
+    EXPECT(m.size() == ref.size() && m.empty() == ref.empty());
+    EXPECT(m.load_factor() <= 0.875 && (m.bucket_count() & (m.bucket_count() - 1)) == 0);
+    size_t seen = 0;
+    auto it = m.cbegin();
+    for(; it != m.cend(); ++it, ++seen) {
+        const auto r = ref.find(it->first);
+        EXPECT(r != ref.end() && r->second == it->second && m.find(it->first) == it);
+    }
+    EXPECT(seen == ref.size());
+    for(; seen; seen--) EXPECT(ref.count((--it)->first));
+    EXPECT(it == m.cbegin());
+}
+
+template<class Map>
+void fuzz(long n, unsigned seed, int range) {
+    Map m;
+    Ref ref;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 8;
+        const std::string v = std::to_string(step);
+        if(op == 0) EXPECT(m.insert(sjtu::pair<const int, std::string>(key, v)).second == ref.insert(std::make_pair(key, v)).second);
+        else if(op == 1) { int k = key; m[std::move(k)] = v, ref[key] = v; }
+        else if(op == 2) EXPECT(m.emplace(key, v).second == ref.emplace(key, v).second);
+        else if(op == 3 || op == 4) EXPECT(m.erase(key) == ref.erase(key));
+        else if(op == 5) {
+            const auto it = m.find(key);
+            EXPECT((it == m.end()) == !ref.count(key));
+            if(it != m.end()) m.erase(it), ref.erase(key);
+        } else if(op == 6) {
+            bool thrown = false;
+            try { const std::string got = m.at(key); EXPECT(ref.count(key) && ref.at(key) == got); } catch(sjtu::index_out_of_bound &) { thrown = true; }
+            EXPECT(thrown == !ref.count(key));
+        } else EXPECT(m.count(key) == ref.count(key));
+        if(step % 16384 == 0) { // copies stay apart from the original, moves leave it empty.
+            Map copy(m), assigned;
+            assigned = m;
+            Ref changed(ref);
+            copy[key] = changed[key] = "changed";
+            same(assigned, ref, step);
+            Map moved(std::move(assigned));
+            same(assigned, Ref(), step), same(moved, ref, step);
+            same(m, ref, step), same(copy, changed, step);
+        } else if(step % 4096 == 0) same(m, ref, step);
+        if(step == n / 2) m.clear(), ref.clear();
+        else if(step == n / 4) m.reserve(m.size() + 1000);
+        if(failures) return;
+    }
+    same(m, ref, n);
+}
+
+void churn(unsigned seed) { // the same small set inserted and erased over and over must not fill the table with tombstones.
+    long step = 0;
+    sjtu::unordered_map<int, int> m;
+    for(int i = 0; i < 100; i++) m[i] = i;
+    const size_t cap = m.bucket_count();
+    for(step = 0; step < 200000; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = 100 + int(seed % 1000000);
+        m[key] = 0, m.erase(key);
+    }
+    EXPECT(m.size() == 100 && m.bucket_count() <= 2 * cap);
+    for(int i = 0; i < 100; i++) EXPECT(m.at(i) == i);
+}
+
+void copies() { // the rvalue paths move the mapped value and the key handed to operator[].
+    long step = 0;
+    sjtu::unordered_map<int, Counted> values;
+    sjtu::unordered_map<Counted, int, CountedHash> keys;
+    keys.reserve(100); // a rehash moves the elements, and moving a pair<const Key, T> copies the key.
+    Counted::copies = 0;
+    for(int i = 0; i < 100; i++) values.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+    for(int i = 0; i < 100; i++) keys[Counted(i)] = i;
+    EXPECT(Counted::copies == 0 && values.size() == 100 && keys.size() == 100);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 200000;
+    const unsigned seed = argc > 2 ? unsigned(atol(argv[2])) : 2333;
+    for(int range : {16, 1000, 1 << 30}) fuzz<sjtu::unordered_map<int, std::string> >(n, seed + range, range);
+    fuzz<sjtu::unordered_map<int, std::string, Crowded> >(n / 10, seed, 1000);
+    churn(seed);
+    copies();
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+#ifndef SJTU_CONCURRENT_PRIORITY_QUEUE_HPP
+#define SJTU_CONCURRENT_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * a priority queue that many threads push to and pop from at once: a MultiQueue, the elements are spread over
+ * several leftist heaps, each behind its own lock, and a push goes to a random one.
+ * queue_order::relaxed: a pop takes the better top of two random heaps. it may miss the global best, by a rank
+ * about the number of heaps on average, but the threads seldom meet on a lock.
+ * queue_order::strict: a pop locks every heap and takes the global best, in exactly the order of one heap.
+ * pushes still spread out, the pops are serialized.
+ */
+
+    enum class queue_order { relaxed, strict };
+
+    template<typename T, class Compare = std::less<T> >
+    class concurrent_priority_queue {
+    private:
+        static constexpr int MAX_LANES = 256;
+        struct alignas(64) Lane { // one heap and its lock, on cache lines of their own, see newLanes.
+            std::mutex lock;
+            priority_queue<T, Compare, leftist_policy> q;
+            std::atomic<bool> some; // !q.empty(), read without the lock to pass over empty heaps.
+            explicit Lane(const Compare &comp): q(comp), some(false) {}
+        };
+        void* laneMem;
+        Lane* lane;
+        int lanes;
+        queue_order order;
+        Compare comp;
+        std::atomic<size_t> _size;
+
+        static Lane* newLanes(void* &mem, int n, const Compare &comp) { // operator new aligns only to alignof(max_align_t) before C++17, so round up here.
+            mem = ::operator new(n * sizeof(Lane) + alignof(Lane) - 1);
+            Lane* const ret = reinterpret_cast<Lane*>((reinterpret_cast<uintptr_t>(mem) + alignof(Lane) - 1) & ~uintptr_t(alignof(Lane) - 1));
+            int i = 0;
+            SJTU_TRY { for(; i < n; i++) new(ret + i) Lane(comp); }
+            SJTU_CATCH_ALL { while(i-- > 0) ret[i].~Lane(); ::operator delete(mem); SJTU_RETHROW; }
+            return ret;
+        }
+        static unsigned rnd() {
+            static thread_local unsigned seed = unsigned(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+            seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+            return seed;
+        }
+        template<class... Args>
+        void put(Lane &l, Args&&... args) { // l is locked.
+            l.q.emplace(std::forward<Args>(args)...);
+            l.some.store(true, std::memory_order_relaxed), ++_size;
+        }
+        void take(Lane &l, T &out) { // l is locked and not empty.
+            l.q.pop(out);
+            l.some.store(!l.q.empty(), std::memory_order_relaxed), --_size;
+        }
+        Lane* better(Lane &a, Lane &b) { // both locked, nullptr when both are empty.
+            if(a.q.empty() || b.q.empty()) return a.q.empty() ? (b.q.empty() ? nullptr : &b) : &a;
+            return comp(a.q.top(), b.q.top()) ? &b : &a;
+        }
+        bool popRelaxed(T &out) {
+            for(int tries = 0; tries < 4; tries++) {
+                int a = int(rnd() % lanes), b = int(rnd() % (lanes - 1));
+                if(b >= a) ++b; // two different heaps.
+                if(!lane[a].some.load(std::memory_order_relaxed) && !lane[b].some.load(std::memory_order_relaxed)) continue;
+                std::unique_lock<std::mutex> la(lane[a].lock, std::try_to_lock);
+                if(!la) continue;
+                std::unique_lock<std::mutex> lb(lane[b].lock, std::try_to_lock);
+                if(!lb) continue;
+                Lane* const from = better(lane[a], lane[b]);
+                if(from) { take(*from, out); return true; }
+            }
+            // few elements or much contention: go round every heap, waiting for the locks.
+            for(int i = int(rnd() % lanes), n = 0; n < lanes; n++, i = i + 1 == lanes ? 0 : i + 1) {
+                if(!lane[i].some.load(std::memory_order_relaxed)) continue;
+                std::lock_guard<std::mutex> guard(lane[i].lock);
+                if(!lane[i].q.empty()) { take(lane[i], out); return true; }
+            }
+            return false;
+        }
+        bool popStrict(T &out) { // the locks are taken in index order, so two pops cannot wait on each other.
+            for(int i = 0; i < lanes; i++) lane[i].lock.lock();
+            Lane* from = nullptr;
+            for(int i = 0; i < lanes; i++)
+                if(!lane[i].q.empty() && (from == nullptr || comp(from->q.top(), lane[i].q.top()))) from = &lane[i];
+            if(from) take(*from, out);
+            for(int i = lanes; i-- > 0; ) lane[i].lock.unlock();
+            return from != nullptr;
+        }
+    public:
+        // _lanes = 0 picks twice the number of hardware threads.
+        explicit concurrent_priority_queue(queue_order _order = queue_order::relaxed, int _lanes = 0, const Compare &_comp = Compare())
+            : lanes(_lanes), order(_order), comp(_comp), _size(0) {
+            if(lanes <= 0) lanes = 2 * int(std::thread::hardware_concurrency());
+            if(lanes < 2) lanes = 2;
+            if(lanes > MAX_LANES) lanes = MAX_LANES;
+            lane = newLanes(laneMem, lanes, comp);
+        }
+        concurrent_priority_queue(const concurrent_priority_queue &) = delete;
+        concurrent_priority_queue &operator=(const concurrent_priority_queue &) = delete;
+        ~concurrent_priority_queue() { // no other thread may be left.
+            for(int i = lanes; i-- > 0; ) lane[i].~Lane();
+            ::operator delete(laneMem);
+        }
+
+        void push(const T &e) { emplace(e); }
+        void push(T &&e) { emplace(std::move(e)); }
+        template<class... Args>
+        void emplace(Args&&... args) { // a random heap that is free, or the last one tried if none is.
+            int i = 0;
+            for(int tries = 0; tries < 4; tries++) {
+                i = int(rnd() % lanes);
+                std::unique_lock<std::mutex> l(lane[i].lock, std::try_to_lock);
+                if(l) { put(lane[i], std::forward<Args>(args)...); return; }
+            }
+            std::lock_guard<std::mutex> guard(lane[i].lock);
+            put(lane[i], std::forward<Args>(args)...);
+        }
+        // move the best, or in relaxed order a nearly best, element into out.
+        // false only when every heap was seen empty during the call.
+        bool try_pop(T &out) { return order == queue_order::strict ? popStrict(out) : popRelaxed(out); }
+        void pop(T &out) { if(!try_pop(out)) SJTU_THROW(container_is_empty()); }
+
+        size_t size() const { return _size.load(); } // exact only while no other thread is inside.
+        bool empty() const { return size() == 0; }
+        queue_order ordering() const { return order; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * throughput of concurrent_priority_queue against priority_queue behind one std::mutex.
+ * usage: concurrent_priority_queue_bench [threads...] [-s seconds]
+ * with no thread counts it runs 1, 2, 4, ..., 64.
+ * the queue starts with PREFILL elements, then every thread pushes or pops with equal chance.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "priority_queue.hpp"
+#include "concurrent_priority_queue.hpp"
+
+namespace {
+
+constexpr int PREFILL = 1 << 20;
+
+struct locked_queue { // the baseline: every call takes the lock.
+    sjtu::priority_queue<int> core;
+    std::mutex lock;
+    void push(int x) { std::lock_guard<std::mutex> guard(lock); core.push(x); }
+    bool try_pop(int &x) {
+        std::lock_guard<std::mutex> guard(lock);
+        if(core.empty()) return false;
+        core.pop(x);
+        return true;
+    }
+};
+
+struct relaxed_queue : sjtu::concurrent_priority_queue<int> {
+    relaxed_queue(): sjtu::concurrent_priority_queue<int>(sjtu::queue_order::relaxed) {}
+};
+struct strict_queue : sjtu::concurrent_priority_queue<int> {
+    strict_queue(): sjtu::concurrent_priority_queue<int>(sjtu::queue_order::strict) {}
+};
+
+template<class Queue>
+double run(int threads, double seconds) { // million operations per second over all threads.
+    Queue q;
+    unsigned x = 2333;
+    for(int i = 0; i < PREFILL; i++) x ^= x << 13, x ^= x >> 17, x ^= x << 5, q.push(int(x >> 1));
+    std::atomic<bool> go(false), stop(false);
+    std::atomic<long long> total(0), sum(0); // sum keeps the pops from being optimized away.
+    std::vector<std::thread> th;
+    for(int t = 0; t < threads; t++) th.emplace_back([&, t] {
+        unsigned x = 2333u * (t + 1);
+        long long cnt = 0, got = 0;
+        while(!go.load()) std::this_thread::yield();
+        while(!stop.load(std::memory_order_relaxed)) {
+            for(int i = 0; i < 256; i++, cnt++) {
+                x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+                int v;
+                if(x >> 31) q.push(int(x >> 1));
+                else if(q.try_pop(v)) got += v;
+            }
+        }
+        total += cnt, sum += got;
+    });
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for(auto &x : th) x.join();
+    const double used = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total.load() / used / 1e6;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> threads;
+    double seconds = 1;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-s") && i + 1 < argc) seconds = atof(argv[++i]);
+        else threads.push_back(atoi(argv[i]));
+    }
+    if(threads.empty()) for(int t = 1; t <= 64; t <<= 1) threads.push_back(t);
+    printf("%8s %16s %16s %16s\n", "threads", "mutex Mops/s", "strict Mops/s", "relaxed Mops/s");
+    for(int t : threads)
+        printf("%8d %16.2f %16.2f %16.2f\n", t, run<locked_queue>(t, seconds), run<strict_queue>(t, seconds), run<relaxed_queue>(t, seconds));
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * concurrent_priority_queue against std::multiset on one thread, then many threads pushing and popping at once,
+ * in both orders.
+ * usage: concurrent_priority_queue_test [operations] [threads]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "concurrent_priority_queue.hpp"
+
+namespace {
+
+typedef sjtu::concurrent_priority_queue<int> Queue;
+
+std::atomic<int> failures(0);
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+void single(long n, unsigned seed, sjtu::queue_order order, int lanes) { // strict pops the best, relaxed only some element.
+    Queue* const q = new Queue(order, lanes); // on the heap, where the lanes still have to start on cache lines.
+    std::multiset<int> ref;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        if((seed >> 28) % 2 == 0 || ref.size() < 10) {
+            const int x = int(seed % 1000);
+            if(seed & 1) q->push(x);
+            else q->emplace(x);
+            ref.insert(x);
+        } else {
+            int out;
+            EXPECT(q->try_pop(out));
+            const auto it = ref.find(out);
+            EXPECT(it != ref.end() && (order == sjtu::queue_order::relaxed || out == *ref.rbegin()));
+            ref.erase(it);
+        }
+        EXPECT(q->size() == ref.size() && q->ordering() == order);
+        if(failures) break;
+    }
+    for(long step = n; !ref.empty() && !failures; step++) {
+        int out;
+        q->pop(out);
+        const auto it = ref.find(out);
+        EXPECT(it != ref.end());
+        ref.erase(it);
+    }
+    long step = n;
+    int out;
+    bool thrown = false;
+    try { q->pop(out); } catch(sjtu::container_is_empty &) { thrown = true; }
+    EXPECT(thrown && !q->try_pop(out) && q->empty());
+    delete q;
+}
+
+void shared(long n, int threads, sjtu::queue_order order) {
+    long step = 0;
+    Queue q(order);
+    std::vector<std::vector<int> > got(threads);
+    std::vector<std::thread> th;
+    for(int t = 0; t < threads; t++) th.emplace_back([&q, n, t, threads] { // every value once over all threads.
+        for(long i = t; i < n; i += threads) q.push(int(i));
+    });
+    for(auto &x : th) x.join();
+    th.clear();
+    EXPECT(q.size() == size_t(n));
+    for(int t = 0; t < threads; t++) th.emplace_back([&q, &got, n, t, threads, order] { // only pops: strict order is per thread decreasing.
+        int out;
+        for(long i = 0; i < n / threads / 2 && q.try_pop(out); i++) {
+            if(order == sjtu::queue_order::strict && !got[t].empty() && out > got[t].back()) { printf("thread %d: %d after %d\n", t, out, got[t].back()), ++failures; return; }
+            got[t].push_back(out);
+        }
+    });
+    for(auto &x : th) x.join();
+    th.clear();
+    for(int t = 0; t < threads; t++) th.emplace_back([&q, &got, n, t, threads] { // pushes and pops mixed, then drained.
+        unsigned x = 2333u * (t + 1);
+        int out;
+        for(long i = n + t; i < 2 * n; i += threads) {
+            x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+            q.push(int(i));
+            if(x >> 31 && q.try_pop(out)) got[t].push_back(out);
+        }
+        while(q.try_pop(out)) got[t].push_back(out);
+    });
+    for(auto &x : th) x.join();
+    std::vector<char> seen(2 * n);
+    for(int t = 0; t < threads; t++) for(int v : got[t]) {
+        EXPECT(v >= 0 && v < 2 * n && !seen[v]);
+        seen[v] = 1;
+    }
+    for(long v = 0; v < 2 * n; v++) EXPECT(seen[v]);
+    EXPECT(q.empty());
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 200000;
+    const int threads = argc > 2 ? atoi(argv[2]) : 8;
+    for(int lanes : {2, 3, 16}) {
+        single(n / 4, 2333 + lanes, sjtu::queue_order::strict, lanes);
+        single(n / 4, 2333 + lanes, sjtu::queue_order::relaxed, lanes);
+    }
+    shared(n, threads, sjtu::queue_order::strict);
+    shared(n, threads, sjtu::queue_order::relaxed);
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
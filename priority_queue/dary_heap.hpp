@@ -0,0 +1,174 @@
+#ifndef SJTU_DARY_HEAP_HPP
+#define SJTU_DARY_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * an implicit heap in one array, every element has D children: the children of i are i * D + 1 ~ i * D + D.
+ * no allocation per element, and a wide D keeps a pop inside few cache lines.
+ */
+
+    template<typename T, class Compare = std::less<T>, int D = 4>
+    class dary_heap {
+        static_assert(D >= 2, "a heap needs at least two children per element");
+    private:
+        T* dat; // dat[0, _size) are built, the rest is raw memory.
+        size_t _size, cap;
+        Compare comp;
+
+        void reserve(size_t n) { // room for n elements.
+            if(n <= cap) return;
+            size_t ncap = cap ? cap : 16;
+            while(ncap < n) ncap *= 2;
+            T* const nd = static_cast<T*>(::operator new(ncap * sizeof(T)));
+            size_t i = 0;
+            SJTU_TRY {
+                for(; i < _size; i++) new(nd + i) T(std::move_if_noexcept(dat[i]));
+            } SJTU_CATCH_ALL {
+                while(i) nd[--i].~T();
+                ::operator delete(nd);
+                SJTU_RETHROW;
+            }
+            destroy();
+            dat = nd, cap = ncap;
+        }
+        void destroy() {
+            for(size_t i = 0; i < _size; i++) dat[i].~T();
+            ::operator delete(dat);
+        }
+        void siftUp(size_t i) { // the hole moves up, the element is written once.
+            T x(std::move(dat[i]));
+            while(i) {
+                const size_t p = (i - 1) / D;
+                if(!comp(dat[p], x)) break;
+                dat[i] = std::move(dat[p]), i = p;
+            }
+            dat[i] = std::move(x);
+        }
+        void siftDown(size_t i) {
+            T x(std::move(dat[i]));
+            while(1) {
+                const size_t c = i * D + 1;
+                if(c >= _size) break;
+                const size_t e = c + D < _size ? c + D : _size;
+                size_t best = c;
+                for(size_t j = c + 1; j < e; j++) if(comp(dat[best], dat[j])) best = j;
+                if(!comp(x, dat[best])) break;
+                dat[i] = std::move(dat[best]), i = best;
+            }
+            dat[i] = std::move(x);
+        }
+        void heapify() { if(_size > 1) for(size_t i = (_size - 2) / D + 1; i-- > 0; ) siftDown(i); } // Floyd, O(n).
+        void settle(size_t old) { // dat[old, _size) were appended: sift them up when few, rebuild otherwise.
+            if((_size - old) * 8 < old) for(size_t i = old; i < _size; i++) siftUp(i);
+            else heapify();
+        }
+        struct ByIndex { // orders positions of dat by their elements.
+            const dary_heap* bel;
+            bool operator()(size_t a, size_t b) const { return bel->comp(bel->dat[a], bel->dat[b]); }
+        };
+        template<class Visit>
+        void best(size_t k, Visit visit) const { // the k best positions in order, walking down from the root: O(k log k).
+            dary_heap<size_t, ByIndex> frontier(ByIndex{this});
+            if(k && _size) frontier.push(0);
+            for(; k && !frontier.empty(); k--) {
+                const size_t i = frontier.top();
+                frontier.pop();
+                for(size_t c = i * D + 1; c <= i * D + D && c < _size; c++) frontier.push(c);
+                visit(i); // the children are in, dat[i] may be moved from.
+            }
+        }
+    public:
+        dary_heap(): dat(nullptr), _size(0), cap(0) {}
+        explicit dary_heap(const Compare &_comp): dat(nullptr), _size(0), cap(0), comp(_comp) {}
+        dary_heap(const dary_heap &other): dat(nullptr), _size(0), cap(0), comp(other.comp) {
+            reserve(other._size);
+            for(; _size < other._size; _size++) new(dat + _size) T(other.dat[_size]);
+        }
+        template<class InputIterator>
+        dary_heap(InputIterator first, InputIterator last, const Compare &_comp = Compare()): dat(nullptr), _size(0), cap(0), comp(_comp) { push_range(first, last); }
+        dary_heap(dary_heap &&other): dat(nullptr), _size(0), cap(0), comp(other.comp) { swap(other); } // O(1), other becomes empty.
+        ~dary_heap() { destroy(); }
+        dary_heap &operator=(const dary_heap &other) {
+            if(this == &other) return *this;
+            dary_heap tmp(other);
+            swap(tmp);
+            return *this;
+        }
+        dary_heap &operator=(dary_heap &&other) {
+            if(this == &other) return *this;
+            dary_heap tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+        void swap(dary_heap &other) { std::swap(dat, other.dat), std::swap(_size, other._size), std::swap(cap, other.cap), std::swap(comp, other.comp); }
+
+        const T & top() const {
+            if(_size == 0) SJTU_THROW(container_is_empty());
+            return dat[0];
+        }
+        void push(const T &e) { emplace(e); }
+        void push(T &&e) { emplace(std::move(e)); }
+        template<class... Args>
+        void emplace(Args&&... args) {
+            if(_size == cap) { T x(std::forward<Args>(args)...); reserve(_size + 1), new(dat + _size) T(std::move(x)); } // args may live in dat.
+            else new(dat + _size) T(std::forward<Args>(args)...);
+            siftUp(_size++);
+        }
+        void pop() {
+            if(_size == 0) SJTU_THROW(container_is_empty());
+            if(--_size) dat[0] = std::move(dat[_size]);
+            dat[_size].~T();
+            if(_size > 1) siftDown(0);
+        }
+        template<class InputIterator>
+        void push_range(InputIterator first, InputIterator last) { // append everything, then one settle: O(n + k) at worst.
+            const size_t old = _size;
+            SJTU_TRY {
+                for(; first != last; ++first, ++_size) {
+                    if(_size == cap) { T x(*first); reserve(_size + 1), new(dat + _size) T(std::move(x)); }
+                    else new(dat + _size) T(*first);
+                }
+            } SJTU_CATCH_ALL {
+                settle(old);
+                SJTU_RETHROW;
+            }
+            settle(old);
+        }
+        void pop(T &out) { // move the top into out, then pop it.
+            if(_size == 0) SJTU_THROW(container_is_empty());
+            out = std::move(dat[0]);
+            pop();
+        }
+        template<class OutputIterator>
+        OutputIterator top_k(size_t k, OutputIterator out) const { // copy the k best, best first, the heap is not touched: O(k log k).
+            best(k, [&](size_t i) { *out++ = dat[i]; });
+            return out;
+        }
+        template<class OutputIterator>
+        OutputIterator pop_k(size_t k, OutputIterator out) { // move the k best out, best first: k pops, which beat picking them
+            for(; k && _size; k--) *out++ = std::move(dat[0]), pop(); // out by their positions and rebuilding even for k = n.
+            return out;
+        }
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        void merge(dary_heap &other) { // the array has to be rebuilt: O(m log n) for a small other, O(n + m) otherwise.
+            if(this == &other || other._size == 0) return;
+            reserve(_size + other._size);
+            const size_t old = _size;
+            for(size_t i = 0; i < other._size; i++) new(dat + _size) T(std::move(other.dat[i])), other.dat[i].~T(), ++_size;
+            other._size = 0;
+            settle(old);
+        }
+    };
+
+}
+
+#endif
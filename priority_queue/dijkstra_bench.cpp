@@ -0,0 +1,111 @@
+/**
+ * shortest paths on a random graph, once with duplicate entries skipped on pop and once with decrease_key.
+ * the distances popped never decrease, so the radix heap of monotone_priority_queue applies as well.
+ * usage: dijkstra_bench [vertices] [edges per vertex]
+ * every run must find the same distances, the sum of them is printed as a check.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <queue>
+#include <vector>
+#include "priority_queue.hpp"
+#include "monotone_priority_queue.hpp"
+
+namespace {
+
+struct Entry {
+    long long dis;
+    int v;
+};
+struct Later { // a min-heap on dis.
+    bool operator()(const Entry &a, const Entry &b) const { return a.dis > b.dis; }
+};
+struct DisOf { // the key for the radix heap.
+    unsigned long long operator()(const Entry &e) const { return e.dis; }
+};
+const long long INF = 1ll << 62;
+
+struct Graph { // adjacency in one array, the edges of u are [head[u], head[u + 1]).
+    std::vector<int> head, to, len;
+    Graph(int n, int deg) {
+        unsigned seed = 2333;
+        auto rnd = [&] { seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5; return seed; };
+        head.resize(n + 1), to.resize(size_t(n) * deg), len.resize(size_t(n) * deg);
+        for(int u = 0; u <= n; u++) head[u] = u * deg;
+        for(size_t e = 0; e < to.size(); e++) to[e] = int(rnd() % n), len[e] = int(rnd() % 1000000) + 1;
+    }
+    int size() const { return int(head.size()) - 1; }
+};
+
+template<class Q>
+long long lazy(const Graph &g, size_t &peak) { // push on every improvement, skip stale entries.
+    std::vector<long long> dis(g.size(), INF);
+    Q q;
+    dis[0] = 0, q.push(Entry{0, 0}), peak = 1;
+    while(!q.empty()) {
+        const Entry cur = q.top();
+        q.pop();
+        if(cur.dis != dis[cur.v]) continue;
+        for(int e = g.head[cur.v]; e < g.head[cur.v + 1]; e++) {
+            const long long nd = cur.dis + g.len[e];
+            if(nd < dis[g.to[e]]) dis[g.to[e]] = nd, q.push(Entry{nd, g.to[e]});
+        }
+        if(q.size() > peak) peak = q.size();
+    }
+    long long sum = 0;
+    for(long long d : dis) if(d != INF) sum += d;
+    return sum;
+}
+template<class Q>
+long long addressable(const Graph &g, size_t &peak) { // one entry per vertex, moved up by decrease_key.
+    std::vector<long long> dis(g.size(), INF);
+    std::vector<typename Q::handle> at(g.size());
+    std::vector<char> queued(g.size(), 0);
+    Q q;
+    dis[0] = 0, at[0] = q.push(Entry{0, 0}), queued[0] = 1, peak = 1;
+    while(!q.empty()) {
+        const Entry cur = q.top();
+        q.pop(), queued[cur.v] = 0;
+        for(int e = g.head[cur.v]; e < g.head[cur.v + 1]; e++) {
+            const int v = g.to[e];
+            const long long nd = cur.dis + g.len[e];
+            if(nd >= dis[v]) continue;
+            if(queued[v]) q.decrease_key(at[v], Entry{nd, v});
+            else at[v] = q.push(Entry{nd, v}), queued[v] = 1; // a settled vertex never improves.
+            dis[v] = nd;
+        }
+        if(q.size() > peak) peak = q.size();
+    }
+    long long sum = 0;
+    for(long long d : dis) if(d != INF) sum += d;
+    return sum;
+}
+
+template<class F>
+void row(const char* name, F f) {
+    size_t peak = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const long long sum = f(peak);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%-26s %10.1f %12zu %20lld\n", name, ms, peak, sum);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? atoi(argv[1]) : 1000000, deg = argc > 2 ? atoi(argv[2]) : 8;
+    const Graph g(n, deg);
+    typedef sjtu::priority_queue<Entry, Later, sjtu::leftist_policy> leftist;
+    typedef sjtu::priority_queue<Entry, Later, sjtu::pairing_policy> pairing;
+    typedef sjtu::priority_queue<Entry, Later, sjtu::dary_policy<4> > dary;
+    printf("%d vertices, %d edges each\n%-26s %10s %12s %20s\n", n, deg, "queue", "ms", "peak size", "sum of distances");
+    row("std lazy", [&](size_t &peak) { return lazy<std::priority_queue<Entry, std::vector<Entry>, Later> >(g, peak); });
+    row("dary<4> lazy", [&](size_t &peak) { return lazy<dary>(g, peak); });
+    row("leftist lazy", [&](size_t &peak) { return lazy<leftist>(g, peak); });
+    row("leftist decrease_key", [&](size_t &peak) { return addressable<leftist>(g, peak); });
+    row("pairing lazy", [&](size_t &peak) { return lazy<pairing>(g, peak); });
+    row("pairing decrease_key", [&](size_t &peak) { return addressable<pairing>(g, peak); });
+    row("radix lazy", [&](size_t &peak) { return lazy<sjtu::monotone_priority_queue<Entry, DisOf> >(g, peak); });
+    return 0;
+}
@@ -2,38 +2,93 @@
 #define SJTU_EXCEPTIONS_HPP
 
 #include <cstddef>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
-#include <string>
+#include <exception>
+
+/**
+ * nothing here allocates: the kind of an exception is a static string, and an optional detail is copied into a
+ * fixed buffer, cut short when too long. what() gives "kind" or "kind: detail".
+ * with SJTU_NO_EXCEPTIONS defined, e.g. for -fno-exceptions, SJTU_THROW passes the exception to the handler set by
+ * set_error_handler, if any, and then aborts. the containers throw only through SJTU_THROW and clean up after a
+ * failed construction only through SJTU_TRY, SJTU_CATCH_ALL and SJTU_RETHROW, whose cleanup never runs then.
+ */
 
 namespace sjtu {
 
 class exception {
 protected:
-	const std::string variant = "";
-	std::string detail = "";
+	static constexpr size_t MESSAGE = 80;
+	const char* variant; // static, never copied.
+	char msg[MESSAGE]; // "variant: detail", empty without a detail.
+	explicit exception(const char* _variant, const char* detail = nullptr) : variant(_variant) {
+		msg[0] = '\0';
+		if(detail == nullptr) return;
+		size_t n = 0;
+		for(const char* p = variant; *p && n + 1 < MESSAGE; ) msg[n++] = *p++;
+		for(const char* p = ": "; *p && n + 1 < MESSAGE; ) msg[n++] = *p++;
+		for(const char* p = detail; *p && n + 1 < MESSAGE; ) msg[n++] = *p++;
+		msg[n] = '\0';
+	}
 public:
-	exception() {}
-	exception(const exception &ec) : variant(ec.variant), detail(ec.detail) {}
-	virtual std::string what() {
-		return variant + " " + detail;
+	exception() : variant("exception") { msg[0] = '\0'; }
+	exception(const exception &ec) : variant(ec.variant) { std::memcpy(msg, ec.msg, MESSAGE); }
+	virtual ~exception() {}
+	virtual const char* what() const noexcept {
+		return msg[0] ? msg : variant;
 	}
 };
 
 class index_out_of_bound : public exception {
-	/* __________________________ */
+public:
+	explicit index_out_of_bound(const char* detail = nullptr) : exception("index_out_of_bound", detail) {}
 };
 
 class runtime_error : public exception {
-	/* __________________________ */
+public:
+	explicit runtime_error(const char* detail = nullptr) : exception("runtime_error", detail) {}
 };
 
 class invalid_iterator : public exception {
-	/* __________________________ */
+public:
+	explicit invalid_iterator(const char* detail = nullptr) : exception("invalid_iterator", detail) {}
 };
 
 class container_is_empty : public exception {
-	/* __________________________ */
+public:
+	explicit container_is_empty(const char* detail = nullptr) : exception("container_is_empty", detail) {}
 };
+
+typedef void (*error_handler)(const exception &);
+inline error_handler &current_error_handler() { static error_handler h = nullptr; return h; }
+inline error_handler set_error_handler(error_handler h) { // returns the one before.
+	const error_handler old = current_error_handler();
+	current_error_handler() = h;
+	return old;
 }
+[[noreturn]] inline void fail(const exception &e) { // where SJTU_THROW ends without exceptions.
+	if(current_error_handler()) current_error_handler()(e);
+	std::fprintf(stderr, "sjtu: %s\n", e.what());
+	std::abort();
+}
+[[noreturn]] inline void fail(const std::exception &e) { // e.g. std::bad_alloc, the handler does not see these.
+	std::fprintf(stderr, "sjtu: %s\n", e.what());
+	std::abort();
+}
+
+}
+
+#ifdef SJTU_NO_EXCEPTIONS
+#define SJTU_THROW(e) ::sjtu::fail(e)
+#define SJTU_TRY if(true)
+#define SJTU_CATCH_ALL if(false)
+#define SJTU_RETHROW ((void)0)
+#else
+#define SJTU_THROW(e) throw e
+#define SJTU_TRY try
+#define SJTU_CATCH_ALL catch(...)
+#define SJTU_RETHROW throw
+#endif
 
 #endif
@@ -0,0 +1,160 @@
+#ifndef SJTU_EXTERNAL_PRIORITY_QUEUE_HPP
+#define SJTU_EXTERNAL_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include "exceptions.hpp"
+#include "dary_heap.hpp"
+
+namespace sjtu {
+
+/**
+ * a priority queue bigger than the memory it may use. new elements go to an insertion heap in memory; when that is
+ * full it is written out, best first, as a sorted run to a temp file. top and pop look at the insertion heap and at
+ * the head of every run, each run read back one block at a time, so a pop is a k-way merge step.
+ * when the run buffers would not fit the budget any more, the runs are merged into one first.
+ * the temp files are unlinked as soon as they are open, nothing is left behind.
+ * T is written byte for byte, so it has to be trivially copyable.
+ */
+
+    template<typename T, class Compare = std::less<T> >
+    class external_priority_queue {
+        static_assert(std::is_trivially_copyable<T>::value, "elements are written to disk byte for byte");
+    private:
+        struct Run { // a sorted run on disk and the block of it in memory.
+            FILE* f;
+            size_t left; // elements still on disk.
+            T* buf;
+            size_t pos, len; // buf[pos, len) are not popped yet.
+            const T & head() const { return buf[pos]; }
+        };
+        struct ByHead {
+            const Compare* comp;
+            bool operator()(const Run* a, const Run* b) const { return (*comp)(a->head(), b->head()); }
+        };
+
+        Compare comp;
+        std::string dir;
+        size_t budget, block, maxRuns, insCap;
+        dary_heap<T, Compare> ins;
+        dary_heap<Run*, ByHead> runs; // by their heads.
+        T* obuf; // one block for writing.
+        size_t _size;
+
+        Run* newRun() {
+            std::string path = dir + "/sjtu_pq_XXXXXX";
+            const int fd = mkstemp(&path[0]);
+            if(fd < 0) SJTU_THROW(runtime_error());
+            unlink(path.c_str()); // gone once closed.
+            FILE* const f = fdopen(fd, "w+b");
+            if(f == nullptr) { close(fd); SJTU_THROW(runtime_error()); }
+            setvbuf(f, nullptr, _IONBF, 0); // whole blocks only, stdio need not copy them again.
+            Run* const r = new Run{f, 0, nullptr, 0, 0};
+            SJTU_TRY { r->buf = static_cast<T*>(::operator new(block * sizeof(T))); }
+            SJTU_CATCH_ALL { fclose(f), delete r; SJTU_RETHROW; }
+            return r;
+        }
+        void deleteRun(Run* r) { fclose(r->f), ::operator delete(r->buf), delete r; }
+        void write(Run* r, size_t n) { // obuf[0, n) to the end of r.
+            if(n && fwrite(obuf, sizeof(T), n, r->f) != n) SJTU_THROW(runtime_error());
+            r->left += n;
+        }
+        void load(Run* r) { // the next block, len = 0 when the run is done.
+            r->pos = 0, r->len = r->left < block ? r->left : block;
+            if(r->len && fread(r->buf, sizeof(T), r->len, r->f) != r->len) SJTU_THROW(runtime_error());
+            r->left -= r->len;
+        }
+        void start(Run* r) { // written, now read it from the top.
+            if(fflush(r->f) || fseek(r->f, 0, SEEK_SET)) { deleteRun(r); SJTU_THROW(runtime_error()); }
+            SJTU_TRY { load(r); } SJTU_CATCH_ALL { deleteRun(r); SJTU_RETHROW; }
+            runs.push(r);
+        }
+        void spill() { // the insertion heap becomes a run.
+            if(runs.size() + 1 >= maxRuns) compact();
+            Run* const r = newRun();
+            SJTU_TRY {
+                size_t n = 0;
+                while(!ins.empty()) {
+                    ins.pop(obuf[n++]);
+                    if(n == block) write(r, n), n = 0;
+                }
+                write(r, n);
+            } SJTU_CATCH_ALL { deleteRun(r); SJTU_RETHROW; }
+            start(r);
+        }
+        void compact() { // merge every run into one, through the write block.
+            Run* const r = newRun();
+            SJTU_TRY {
+                size_t n = 0;
+                while(!runs.empty()) {
+                    Run* const s = runs.top();
+                    runs.pop();
+                    obuf[n++] = s->buf[s->pos++];
+                    if(n == block) write(r, n), n = 0;
+                    if(s->pos == s->len) load(s);
+                    if(s->len) runs.push(s);
+                    else deleteRun(s);
+                }
+                write(r, n);
+            } SJTU_CATCH_ALL { deleteRun(r); SJTU_RETHROW; }
+            start(r);
+        }
+        bool fromIns() const { return runs.empty() || (!ins.empty() && !comp(ins.top(), runs.top()->head())); }
+    public:
+        // memory: bytes for the insertion heap and the run blocks together, temp_dir: where the runs go,
+        // TMPDIR or /tmp when empty.
+        explicit external_priority_queue(size_t memory = size_t(64) << 20, const std::string &temp_dir = "", const Compare &_comp = Compare())
+            : comp(_comp), dir(temp_dir), budget(memory), ins(_comp), runs(ByHead{&comp}), obuf(nullptr), _size(0) {
+            if(dir.empty()) { const char* const env = getenv("TMPDIR"); dir = env && *env ? env : "/tmp"; }
+            block = (size_t(64) << 10) / sizeof(T); // 64 KiB of I/O at a time,
+            if(block * sizeof(T) * 16 > budget / 2) block = budget / 2 / 16 / sizeof(T); // but at least 16 runs in half the budget.
+            if(block == 0) block = 1;
+            maxRuns = budget / 2 / (block * sizeof(T)); // the other half holds the insertion heap,
+            if(maxRuns < 3) maxRuns = 3;
+            for(insCap = 16; insCap * 2 * sizeof(T) <= budget / 2; ) insCap *= 2; // whose array grows in powers of two.
+            obuf = static_cast<T*>(::operator new(block * sizeof(T)));
+        }
+        external_priority_queue(const external_priority_queue &) = delete;
+        external_priority_queue &operator=(const external_priority_queue &) = delete;
+        ~external_priority_queue() {
+            Run* r;
+            while(!runs.empty()) runs.pop(r), deleteRun(r);
+            ::operator delete(obuf);
+        }
+
+        // throw container_is_empty if empty() returns true
+        const T & top() const {
+            if(_size == 0) SJTU_THROW(container_is_empty());
+            return fromIns() ? ins.top() : runs.top()->head();
+        }
+        void push(const T &e) { // throw runtime_error when a temp file cannot be made, written or read.
+            if(ins.size() == insCap) spill();
+            ins.push(e), ++_size;
+        }
+        void pop() {
+            if(_size == 0) SJTU_THROW(container_is_empty());
+            --_size;
+            if(fromIns()) { ins.pop(); return; }
+            Run* const r = runs.top();
+            runs.pop();
+            SJTU_TRY { if(++r->pos == r->len) load(r); }
+            SJTU_CATCH_ALL { deleteRun(r); SJTU_RETHROW; }
+            if(r->len) runs.push(r);
+            else deleteRun(r);
+        }
+        void pop(T &out) { out = top(), pop(); }
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        size_t run_count() const { return runs.size(); } // sorted runs on disk now.
+        size_t memory_budget() const { return budget; }
+        const std::string & temp_dir() const { return dir; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * external_priority_queue on 16-byte records with a memory budget far below the data, against priority_queue in memory.
+ * usage: external_priority_queue_bench [records] [budget MiB] [temp dir]
+ * every record is pushed, then all are popped; the pops must come out in order, and the ids are summed as a check.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include "priority_queue.hpp"
+#include "external_priority_queue.hpp"
+
+namespace {
+
+struct Record {
+    unsigned long long key, id;
+};
+struct Later { // a min-heap on key.
+    bool operator()(const Record &a, const Record &b) const { return a.key > b.key; }
+};
+
+template<class F>
+double timed(F f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<class Q>
+size_t runsOf(const Q &) { return 0; }
+template<class T, class Compare>
+size_t runsOf(const sjtu::external_priority_queue<T, Compare> &q) { return q.run_count(); }
+
+template<class Q>
+void run(const char* name, Q &q, long long n) {
+    unsigned long long x = 2333, sum = 0;
+    bool sorted = true;
+    const double push = timed([&] {
+        for(long long i = 0; i < n; i++) x ^= x << 13, x ^= x >> 7, x ^= x << 17, q.push(Record{x, (unsigned long long)i});
+    });
+    const size_t runs = runsOf(q);
+    const double pop = timed([&] {
+        unsigned long long last = 0;
+        while(!q.empty()) {
+            const Record r = q.top();
+            q.pop();
+            sorted &= r.key >= last, last = r.key, sum += r.id;
+        }
+    });
+    printf("%-22s %12.1f %12.1f %8zu %22llu %s\n", name, push, pop, runs, sum, sorted ? "" : "NOT SORTED");
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long long n = argc > 1 ? atoll(argv[1]) : 20000000;
+    const size_t budget = size_t(argc > 2 ? atoi(argv[2]) : 16) << 20;
+    const std::string dir = argc > 3 ? argv[3] : "";
+    printf("%lld records, %.0f MiB of data, budget %zu MiB\n", n, n * sizeof(Record) / 1048576.0, budget >> 20);
+    printf("%-22s %12s %12s %8s %22s\n", "queue", "push ms", "pop ms", "runs", "sum of ids");
+    {
+        sjtu::external_priority_queue<Record, Later> q(budget, dir);
+        run("external", q, n);
+    }
+    {
+        sjtu::priority_queue<Record, Later, sjtu::dary_policy<4> > q;
+        run("dary<4> in memory", q, n);
+    }
+    return 0;
+}
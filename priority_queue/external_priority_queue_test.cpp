@@ -0,0 +1,100 @@
+/**
+ * external_priority_queue against std::multiset, with budgets small enough that nearly every push spills or compacts,
+ * then the error paths and the temp directory left behind.
+ * usage: external_priority_queue_test [operations] [seed]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <dirent.h>
+#include <unistd.h>
+#include "external_priority_queue.hpp"
+
+namespace {
+
+struct Record { // ordered by key, the id tells equal keys apart.
+    unsigned key, id;
+    bool operator<(const Record &rhs) const { return key < rhs.key || (key == rhs.key && id < rhs.id); }
+    bool operator==(const Record &rhs) const { return key == rhs.key && id == rhs.id; }
+};
+
+int failures = 0;
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+size_t entries(const std::string &dir) { // besides . and ..
+    size_t ret = 0;
+    DIR* const d = opendir(dir.c_str());
+    if(d == nullptr) return size_t(-1);
+    while(dirent* e = readdir(d)) if(std::string(e->d_name) != "." && std::string(e->d_name) != "..") ++ret;
+    closedir(d);
+    return ret;
+}
+
+template<typename T, class Make>
+void fuzz(long n, unsigned seed, size_t budget, const std::string &dir, Make make) { // pushes and pops mixed, in phases.
+    sjtu::external_priority_queue<T> q(budget, dir);
+    std::multiset<T> ref;
+    long step = 0;
+    EXPECT(q.memory_budget() == budget && q.temp_dir() == dir);
+    for(; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int pushes = (step / 1000) % 3 == 2 ? 1 : 3; // two phases of growth, then one of shrinking.
+        if(int(seed >> 28) % 4 < pushes) {
+            const T x = make(seed, step);
+            q.push(x), ref.insert(x);
+        } else if(ref.empty()) {
+            bool thrown = false;
+            try { q.pop(); } catch(sjtu::container_is_empty &) { thrown = true; }
+            EXPECT(thrown);
+        } else {
+            T out;
+            EXPECT(q.top() == *ref.rbegin());
+            q.pop(out);
+            EXPECT(out == *ref.rbegin());
+            ref.erase(std::prev(ref.end()));
+        }
+        EXPECT(q.size() == ref.size() && q.empty() == ref.empty());
+        if(step % 4096 == 0) EXPECT(entries(dir) == 0); // unlinked while still open.
+        if(failures) return;
+    }
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) {
+        EXPECT(q.top() == *r);
+        q.pop();
+    }
+    EXPECT(q.empty());
+}
+
+void broken() { // no such directory: the first spill throws, and the queue keeps what it had.
+    long step = 0;
+    sjtu::external_priority_queue<int> q(256, "/nonexistent/sjtu_pq");
+    bool thrown = false;
+    int pushed = 0;
+    try { for(; pushed < 1000; pushed++) q.push(pushed); } catch(sjtu::runtime_error &) { thrown = true; }
+    EXPECT(thrown && pushed > 0 && q.size() == size_t(pushed));
+    for(int i = pushed - 1; i >= 0; i--, step++) {
+        EXPECT(q.top() == i);
+        q.pop();
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 100000;
+    const unsigned seed = argc > 2 ? unsigned(atol(argv[2])) : 2333;
+    const char* const env = getenv("TMPDIR");
+    std::string dir = std::string(env && *env ? env : "/tmp") + "/sjtu_pq_test_XXXXXX";
+    if(mkdtemp(&dir[0]) == nullptr) { printf("cannot make a temp directory\n"); return 1; }
+    for(size_t budget : {size_t(256), size_t(4) << 10, size_t(1) << 20}) {
+        fuzz<int>(n, seed + unsigned(budget), budget, dir, [](unsigned x, long) { return int(x % 1000); });
+        fuzz<Record>(n, seed + unsigned(budget), budget, dir, [](unsigned x, long step) { return Record{x % 1000, unsigned(step)}; });
+    }
+    broken();
+    if(entries(dir) != 0) printf("the temp directory is not empty\n"), ++failures;
+    rmdir(dir.c_str());
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}
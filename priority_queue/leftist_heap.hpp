@@ -0,0 +1,288 @@
+#ifndef SJTU_LEFTIST_HEAP_HPP
+#define SJTU_LEFTIST_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+#include "exceptions.hpp"
+#include "node_pool.hpp"
+#include "dary_heap.hpp"
+
+namespace sjtu {
+
+/**
+ * a mergeable heap of nodes, every right spine is at most log(n + 1) long.
+ * nothing recurses: merge walks the right spines with a fixed stack, copy fills one block breadth first,
+ * and destruction rotates the tree apart in O(1) extra space, so a long left path cannot overflow the stack.
+ */
+
+    template<typename T, class Compare = std::less<T> >
+    class leftist_heap {
+    public:
+        class handle;
+    private:
+        struct Node {
+            T val;
+            Node *ls, *rs, *fa;
+            int dis;
+            template<class... Args>
+            Node(Args&&... args): val(std::forward<Args>(args)...), ls(nullptr), rs(nullptr), fa(nullptr), dis(0) {}
+            void maintain() {
+                if(ls == nullptr || (rs != nullptr && ls->dis < rs->dis)) std::swap(ls, rs);
+                dis = (rs == nullptr ? -1 : rs->dis) + 1;
+            }
+        }*root;
+        Compare comp;
+
+        static constexpr int PATH = 128; // two right spines, each at most log(n + 1) long.
+        node_pool<Node> pool;
+
+        template<class... Args>
+        Node* newNode(Args&&... args) {
+            void* const mem = pool.get();
+            SJTU_TRY { return new(mem) Node(std::forward<Args>(args)...); }
+            SJTU_CATCH_ALL { pool.put(static_cast<Node*>(mem)); SJTU_RETHROW; }
+        }
+        void deleteNode(Node* pos) { pos->~Node(), pool.put(pos); }
+        void deleteAll(Node* pos) { // rotate the left child up until there is none, O(1) extra space.
+            while(pos) {
+                if(pos->ls) {
+                    Node* const l = pos->ls;
+                    pos->ls = l->rs, l->rs = pos, pos = l;
+                } else {
+                    Node* const nxt = pos->rs;
+                    pos->~Node();
+                    pos = nxt;
+                }
+            }
+        }
+        Node* copy(const Node* x, size_t n) { // n nodes in one block, built in breadth first order.
+            if(x == nullptr) return nullptr;
+            Node* const blk = pool.array(n);
+            size_t head = 0, tail = 0;
+            auto take = [&](const Node* src) -> Node* { // ls of a node not yet visited holds its source.
+                Node* const ret = new(blk + tail) Node(src->val);
+                ret->ls = const_cast<Node*>(src), ++tail;
+                return ret;
+            };
+            SJTU_TRY {
+                for(take(x); head < tail; head++) {
+                    Node* const d = blk + head;
+                    const Node* const s = d->ls;
+                    d->ls = s->ls ? take(s->ls) : nullptr;
+                    d->rs = s->rs ? take(s->rs) : nullptr;
+                    if(d->ls) d->ls->fa = d;
+                    if(d->rs) d->rs->fa = d;
+                    d->dis = s->dis;
+                }
+            } SJTU_CATCH_ALL {
+                for(size_t i = 0; i < tail; i++) blk[i].~Node();
+                SJTU_RETHROW;
+            }
+            return blk;
+        }
+        Node* merge(Node* a, Node* b) { // walk down both right spines, then fix the path bottom up. the result's fa is left as it was.
+            Node* path[PATH];
+            int len = 0;
+            while(a && b) {
+                if(comp(a->val, b->val)) std::swap(a, b);
+                path[len++] = a, a = a->rs;
+            }
+            Node* ret = a ? a : b;
+            while(len--) {
+                path[len]->rs = ret;
+                if(ret) ret->fa = path[len];
+                path[len]->maintain(), ret = path[len];
+            }
+            return ret;
+        }
+        template<class InputIterator>
+        Node* build(InputIterator first, InputIterator last, size_t &cnt) { // O(n): merge the singletons in pairs, round after round.
+            Node *head = nullptr, *tail = nullptr; // the roots of one round, listed through fa.
+            cnt = 0;
+            SJTU_TRY {
+                for(; first != last; ++first, ++cnt) {
+                    Node* const nv = newNode(*first);
+                    (tail ? tail->fa : head) = nv, tail = nv;
+                }
+            } SJTU_CATCH_ALL {
+                while(head) { Node* const nxt = head->fa; deleteNode(head), head = nxt; }
+                SJTU_RETHROW;
+            }
+            return mergeAll(head);
+        }
+        Node* mergeAll(Node* head) { // the roots listed through fa, merged in pairs round after round.
+            while(head && head->fa) {
+                Node *nhead = nullptr, *ntail = nullptr;
+                while(head) {
+                    Node *const a = head, *const b = a->fa;
+                    head = b ? b->fa : nullptr;
+                    Node* const m = b ? merge(a, b) : a;
+                    m->fa = nullptr, (ntail ? ntail->fa : nhead) = m, ntail = m;
+                }
+                head = nhead;
+            }
+            return head;
+        }
+        struct ByVal { // orders nodes by their elements.
+            const Compare* comp;
+            bool operator()(const Node* a, const Node* b) const { return (*comp)(a->val, b->val); }
+        };
+        typedef dary_heap<Node*, ByVal> frontier_t;
+        template<class Visit>
+        void best(size_t k, frontier_t &frontier, Visit visit) const { // the k best nodes in order, walking down from the root: O(k log k).
+            if(root) frontier.push(root);
+            for(; k && !frontier.empty(); k--) {
+                Node* const x = frontier.top();
+                frontier.pop();
+                if(x->ls) frontier.push(x->ls);
+                if(x->rs) frontier.push(x->rs);
+                visit(x); // the children are in, x may be reused.
+            }
+        }
+        void setRoot(Node* pos) { if((root = pos)) pos->fa = nullptr; }
+        void cut(Node* pos) { // take the subtree of pos, not the root, out of the tree.
+            Node* fa = pos->fa;
+            (fa->ls == pos ? fa->ls : fa->rs) = nullptr, pos->fa = nullptr;
+            for(; fa; fa = fa->fa) { // only a changed dis can break the leftist rule further up.
+                const int old = fa->dis;
+                fa->maintain();
+                if(fa->dis == old) break;
+            }
+        }
+        Node* detach(Node* pos) { // take pos out, its children stay in the heap.
+            Node* const rest = merge(pos->ls, pos->rs);
+            if(pos == root) setRoot(rest);
+            else cut(pos), setRoot(merge(root, rest));
+            pos->ls = pos->rs = nullptr, pos->dis = 0;
+            return pos;
+        }
+        Node* check(const handle &h) const { if(h.nd == nullptr) SJTU_THROW(invalid_iterator()); return h.nd; }
+        size_t _size;
+    public:
+        class handle { // stays valid until its element is popped or erased.
+            friend class leftist_heap;
+            Node* nd;
+            explicit handle(Node* _nd): nd(_nd) {}
+        public:
+            handle(): nd(nullptr) {}
+            const T & operator*() const { return nd->val; }
+            const T* operator->() const { return &nd->val; }
+            bool operator==(const handle &rhs) const { return nd == rhs.nd; }
+            bool operator!=(const handle &rhs) const { return nd != rhs.nd; }
+        };
+
+        leftist_heap(): _size(0) {
+            root = nullptr;
+        }
+        explicit leftist_heap(const Compare &_comp): comp(_comp), _size(0) {
+            root = nullptr;
+        }
+        leftist_heap(const leftist_heap &other): comp(other.comp), _size(other._size) {
+            root = copy(other.root, other._size);
+        }
+        ~leftist_heap() {
+            deleteAll(root);
+        }
+        template<class InputIterator>
+        leftist_heap(InputIterator first, InputIterator last, const Compare &_comp = Compare()): root(nullptr), comp(_comp), _size(0) { push_range(first, last); }
+        leftist_heap(leftist_heap &&other): root(nullptr), comp(other.comp), _size(0) { swap(other); } // O(1), other becomes empty.
+        leftist_heap &operator=(const leftist_heap &other) {
+            if(this == &other) return *this;
+            leftist_heap tmp(other);
+            swap(tmp);
+            return *this;
+        }
+        leftist_heap &operator=(leftist_heap &&other) {
+            if(this == &other) return *this;
+            leftist_heap tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+        void swap(leftist_heap &other) { std::swap(root, other.root), std::swap(comp, other.comp), std::swap(_size, other._size), pool.swap(other.pool); }
+
+        const T & top() const {
+            if(root == nullptr) SJTU_THROW(container_is_empty());
+            return root->val;
+        }
+
+        handle push(const T &e) { return emplace(e); }
+        handle push(T &&e) { return emplace(std::move(e)); }
+        template<class... Args>
+        handle emplace(Args&&... args) { // the node is reused from the pool when one was popped before.
+            Node* const nv = newNode(std::forward<Args>(args)...);
+            setRoot(merge(nv, root));
+            ++_size;
+            return handle(nv);
+        }
+        void pop() {
+            if(root == nullptr) SJTU_THROW(container_is_empty());
+            --_size;
+            Node* mem = root;
+            setRoot(merge(root->ls, root->rs));
+            deleteNode(mem);
+        }
+        template<class InputIterator>
+        void push_range(InputIterator first, InputIterator last) { // O(k + log n) for k new elements.
+            size_t cnt;
+            Node* const sub = build(first, last, cnt);
+            setRoot(merge(root, sub)), _size += cnt;
+        }
+        void pop(T &out) { // move the top into out, then pop it.
+            if(root == nullptr) SJTU_THROW(container_is_empty());
+            out = std::move(root->val);
+            pop();
+        }
+        template<class OutputIterator>
+        OutputIterator top_k(size_t k, OutputIterator out) const { // copy the k best, best first, the heap is not touched: O(k log k).
+            frontier_t frontier(ByVal{&comp});
+            best(k, frontier, [&](Node* x) { *out++ = x->val; });
+            return out;
+        }
+        template<class OutputIterator>
+        OutputIterator pop_k(size_t k, OutputIterator out) { // move the k best out, best first: O(k log k + k log n).
+            if(k == 1 && root) return *out++ = std::move(root->val), pop(), out; // no frontier for a single one.
+            frontier_t frontier(ByVal{&comp});
+            Node* gone = nullptr; // the taken nodes, listed through rs.
+            best(k, frontier, [&](Node* x) { *out++ = std::move(x->val), x->ls = nullptr, x->rs = gone, gone = x, --_size; });
+            Node* head = nullptr; // what is left hangs off the taken nodes, exactly the frontier.
+            for(Node* x; !frontier.empty(); ) frontier.pop(x), x->fa = head, head = x;
+            setRoot(mergeAll(head));
+            while(gone) { Node* const nxt = gone->rs; deleteNode(gone), gone = nxt; }
+            return out;
+        }
+
+        // the element of h moves towards the top: cut its subtree out and merge it with the root, O(log n).
+        void decrease_key(const handle &h, const T &e) {
+            Node* const pos = check(h);
+            if(comp(e, pos->val)) { pos->val = e, update(h); return; } // it got worse after all.
+            pos->val = e;
+            if(pos != root && comp(pos->fa->val, pos->val)) cut(pos), setRoot(merge(root, pos));
+        }
+        void update(const handle &h, const T &e) { check(h)->val = e, update(h); }
+        void update(const handle &h) { // the priority of *h changed in any direction.
+            Node* const pos = check(h);
+            if(pos != root && comp(pos->fa->val, pos->val)) { cut(pos), setRoot(merge(root, pos)); return; }
+            if((pos->ls == nullptr || !comp(pos->val, pos->ls->val)) && (pos->rs == nullptr || !comp(pos->val, pos->rs->val))) return;
+            setRoot(merge(root, detach(pos)));
+        }
+        void erase(const handle &h) { deleteNode(detach(check(h))), --_size; }
+        size_t size() const {
+            return _size;
+        }
+        bool empty() const {
+            return root == nullptr;
+        }
+
+        void merge(leftist_heap &other) { // O(log n), other becomes empty.
+            if(this == &other) return;
+            _size += other._size;
+            setRoot(merge(root, other.root)), pool.splice(other.pool);
+            other.root = nullptr, other._size = 0;
+        }
+    };
+
+}
+
+#endif
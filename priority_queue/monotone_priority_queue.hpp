@@ -0,0 +1,139 @@
+#ifndef SJTU_MONOTONE_PRIORITY_QUEUE_HPP
+#define SJTU_MONOTONE_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * a radix heap: a min-priority queue on unsigned integer keys that only works while the keys taken out never decrease,
+ * i.e. nothing smaller than the last key seen through top or pop is pushed, as with the distances of Dijkstra or event times.
+ * bucket 0 holds the elements with key == last, bucket i > 0 those whose highest bit different from last is bit i - 1.
+ * push is O(1), and pop moves an element only to a lower bucket, O(log C) amortized for keys below C.
+ * KeyOf maps an element to its key.
+ */
+
+    struct identity_key {
+        template<class U>
+        const U & operator()(const U &x) const { return x; }
+    };
+
+    template<typename T, class KeyOf = identity_key>
+    class monotone_priority_queue {
+        typedef typename std::decay<decltype(std::declval<const KeyOf &>()(std::declval<const T &>()))>::type Key;
+        static_assert(std::is_unsigned<Key>::value && sizeof(Key) <= sizeof(unsigned long long), "a radix heap needs unsigned integer keys");
+    private:
+        static constexpr int W = sizeof(Key) * 8;
+
+        struct Bucket { // a growable array, dat[0, siz) are built.
+            T* dat;
+            size_t siz, cap;
+            Bucket(): dat(nullptr), siz(0), cap(0) {}
+            Bucket(const Bucket &other): dat(nullptr), siz(0), cap(0) {
+                reserve(other.siz);
+                for(; siz < other.siz; siz++) new(dat + siz) T(other.dat[siz]);
+            }
+            ~Bucket() { clear(), ::operator delete(dat); }
+            void swap(Bucket &other) { std::swap(dat, other.dat), std::swap(siz, other.siz), std::swap(cap, other.cap); }
+            void reserve(size_t n) {
+                if(n <= cap) return;
+                size_t ncap = cap ? cap : 8;
+                while(ncap < n) ncap *= 2;
+                T* const nd = static_cast<T*>(::operator new(ncap * sizeof(T)));
+                size_t i = 0;
+                SJTU_TRY {
+                    for(; i < siz; i++) new(nd + i) T(std::move_if_noexcept(dat[i]));
+                } SJTU_CATCH_ALL {
+                    while(i) nd[--i].~T();
+                    ::operator delete(nd);
+                    SJTU_RETHROW;
+                }
+                for(i = 0; i < siz; i++) dat[i].~T();
+                ::operator delete(dat);
+                dat = nd, cap = ncap;
+            }
+            void push_back(T &&e) {
+                if(siz == cap) reserve(siz + 1);
+                new(dat + siz) T(std::move(e)), ++siz;
+            }
+            void pop_back() { dat[--siz].~T(); }
+            void clear() { while(siz) pop_back(); } // the memory stays for the next time.
+        };
+
+        mutable Bucket b[W + 1];
+        mutable Key last; // the smallest key in the queue is at least last.
+        mutable unsigned long long used; // bit i - 1 is set when b[i] is not empty, for i > 0.
+        size_t _size;
+        KeyOf key;
+
+        static int bucketOf(Key x, Key base) { return x == base ? 0 : 64 - __builtin_clzll((unsigned long long)(x ^ base)); }
+        void place(T &&e, Key k) const {
+            const int i = bucketOf(k, last);
+            b[i].push_back(std::move(e));
+            if(i) used |= 1ull << (i - 1);
+        }
+        void refill() const { // b[0] is empty but the queue is not: the smallest key becomes last and its bucket is spread below.
+            const int i = __builtin_ctzll(used) + 1;
+            Bucket &src = b[i];
+            Key low = key(src.dat[0]);
+            for(size_t j = 1; j < src.siz; j++) { const Key k = key(src.dat[j]); if(k < low) low = k; }
+            last = low, used &= ~(1ull << (i - 1));
+            for(size_t j = 0; j < src.siz; j++) place(std::move(src.dat[j]), key(src.dat[j])); // every one lands below i.
+            src.clear();
+        }
+    public:
+        monotone_priority_queue(): last(0), used(0), _size(0) {}
+        explicit monotone_priority_queue(const KeyOf &_key): last(0), used(0), _size(0), key(_key) {}
+        monotone_priority_queue(const monotone_priority_queue &other) = default;
+        monotone_priority_queue(monotone_priority_queue &&other): last(0), used(0), _size(0), key(other.key) { swap(other); } // O(W), other becomes empty.
+        monotone_priority_queue &operator=(const monotone_priority_queue &other) {
+            if(this == &other) return *this;
+            monotone_priority_queue tmp(other);
+            swap(tmp);
+            return *this;
+        }
+        monotone_priority_queue &operator=(monotone_priority_queue &&other) {
+            if(this == &other) return *this;
+            monotone_priority_queue tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+        void swap(monotone_priority_queue &other) {
+            for(int i = 0; i <= W; i++) b[i].swap(other.b[i]);
+            std::swap(last, other.last), std::swap(used, other.used), std::swap(_size, other._size), std::swap(key, other.key);
+        }
+
+        // throw container_is_empty if empty() returns true
+        const T & top() const {
+            if(_size == 0) SJTU_THROW(container_is_empty());
+            if(b[0].siz == 0) refill();
+            return b[0].dat[b[0].siz - 1];
+        }
+        void push(const T &e) { push(T(e)); }
+        void push(T &&e) { // throw runtime_error if the key is below the last one seen.
+            const Key k = key(e);
+            if(k < last) SJTU_THROW(runtime_error());
+            place(std::move(e), k), ++_size;
+        }
+        template<class... Args>
+        void emplace(Args&&... args) { push(T(std::forward<Args>(args)...)); }
+        void pop() {
+            top();
+            b[0].pop_back(), --_size;
+        }
+        void pop(T &out) { // move the top into out, then pop it.
+            top();
+            out = std::move(b[0].dat[b[0].siz - 1]);
+            b[0].pop_back(), --_size;
+        }
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SJTU_NODE_POOL_HPP
+#define SJTU_NODE_POOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * raw memory for the nodes of one container, taken from blocks that live as long as the pool.
+ * a node given back is reused by the next get(), so a container that stays the same size allocates nothing.
+ * the pool never builds or destroys a Node, its owner does.
+ */
+
+    template<class Node>
+    class node_pool {
+    private:
+        struct Block {
+            Block* nxt;
+        };
+        struct Free {
+            Free* nxt;
+        };
+        static constexpr size_t HEAD = (sizeof(Block) + alignof(Node) - 1) / alignof(Node) * alignof(Node); // nodes start here in a block.
+        static constexpr size_t FIRST = 16, LAST = 1 << 16; // block sizes, in nodes, doubling from FIRST up to LAST.
+        static_assert(sizeof(Node) >= sizeof(Free), "a free node keeps its link in place");
+
+        Block *blocks, *lastBlock;
+        Free *freed, *lastFree; // the last ones are kept for splice, and only meaningful while their list is not empty.
+        Node *cur, *end; // the unused rest of a block.
+        size_t grow;
+
+        Node* newBlock(size_t n) {
+            Block* const b = static_cast<Block*>(::operator new(HEAD + n * sizeof(Node)));
+            if(blocks == nullptr) lastBlock = b;
+            b->nxt = blocks, blocks = b;
+            return reinterpret_cast<Node*>(reinterpret_cast<char*>(b) + HEAD);
+        }
+    public:
+        node_pool(): blocks(nullptr), lastBlock(nullptr), freed(nullptr), lastFree(nullptr), cur(nullptr), end(nullptr), grow(FIRST) {}
+        node_pool(const node_pool &) = delete;
+        node_pool &operator=(const node_pool &) = delete;
+        ~node_pool() { clear(); }
+
+        void* get() {
+            if(freed) { Free* const ret = freed; freed = freed->nxt; return ret; }
+            if(cur == end) cur = newBlock(grow), end = cur + grow, grow = grow < LAST ? grow * 2 : LAST;
+            return cur++;
+        }
+        void put(Node* pos) { // pos is destroyed already.
+            Free* const f = reinterpret_cast<Free*>(pos);
+            if(freed == nullptr) lastFree = f;
+            f->nxt = freed, freed = f;
+        }
+        Node* array(size_t n) { return newBlock(n); } // n nodes in a row, in a block of their own.
+        void clear() { // every node must be destroyed already.
+            while(blocks) {
+                Block* const nxt = blocks->nxt;
+                ::operator delete(blocks);
+                blocks = nxt;
+            }
+            lastBlock = nullptr, freed = lastFree = nullptr, cur = end = nullptr, grow = FIRST;
+        }
+        void swap(node_pool &other) {
+            std::swap(blocks, other.blocks), std::swap(lastBlock, other.lastBlock);
+            std::swap(freed, other.freed), std::swap(lastFree, other.lastFree);
+            std::swap(cur, other.cur), std::swap(end, other.end), std::swap(grow, other.grow);
+        }
+        void splice(node_pool &other) { // take over other's blocks, for nodes that moved here: O(1), the lists are linked.
+            if(&other == this || other.blocks == nullptr) return;
+            other.lastBlock->nxt = blocks, blocks = other.blocks;
+            if(lastBlock == nullptr) lastBlock = other.lastBlock;
+            if(other.freed) {
+                other.lastFree->nxt = freed;
+                if(freed == nullptr) lastFree = other.lastFree;
+                freed = other.freed;
+            }
+            if(other.end - other.cur > end - cur) cur = other.cur, end = other.end; // the smaller unused rest stays unused until clear.
+            other.blocks = other.lastBlock = nullptr, other.freed = other.lastFree = nullptr;
+            other.cur = other.end = nullptr, other.grow = FIRST;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef SJTU_PAIRING_HEAP_HPP
+#define SJTU_PAIRING_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+#include "exceptions.hpp"
+#include "node_pool.hpp"
+
+namespace sjtu {
+
+/**
+ * a mergeable heap with O(1) push and merge, and O(log n) amortized pop.
+ * nodes are kept as a binary tree: child is the first child, sib the next sibling, and prv the node pointing here
+ * through child or sib, so the tree can be walked and taken apart without recursion.
+ */
+
+    template<typename T, class Compare = std::less<T> >
+    class pairing_heap {
+    public:
+        class handle;
+    private:
+        struct Node {
+            T val;
+            Node *child, *sib, *prv;
+            template<class... Args>
+            Node(Args&&... args): val(std::forward<Args>(args)...), child(nullptr), sib(nullptr), prv(nullptr) {}
+        }*root;
+        Compare comp;
+        size_t _size;
+        node_pool<Node> pool;
+
+        template<class... Args>
+        Node* newNode(Args&&... args) {
+            void* const mem = pool.get();
+            SJTU_TRY { return new(mem) Node(std::forward<Args>(args)...); }
+            SJTU_CATCH_ALL { pool.put(static_cast<Node*>(mem)); SJTU_RETHROW; }
+        }
+        void deleteNode(Node* pos) { pos->~Node(), pool.put(pos); }
+
+        Node* meld(Node* a, Node* b) { // two roots, the worse one becomes the first child of the better one.
+            if(a == nullptr || b == nullptr) return b == nullptr ? a : b;
+            if(comp(a->val, b->val)) std::swap(a, b);
+            b->sib = a->child, b->prv = a;
+            if(a->child) a->child->prv = b;
+            a->child = b;
+            return a;
+        }
+        Node* combine(Node* first) { // meld a list of siblings into one tree: pair them up left to right, then fold right to left.
+            if(first == nullptr) return nullptr;
+            Node* acc = nullptr; // the pairs, last one first.
+            while(first) {
+                Node *a = first, *b = first->sib;
+                first = b ? b->sib : nullptr;
+                a->sib = a->prv = nullptr;
+                if(b) b->sib = b->prv = nullptr, a = meld(a, b);
+                a->sib = acc, acc = a;
+            }
+            Node* ret = acc;
+            acc = acc->sib, ret->sib = nullptr;
+            while(acc) {
+                Node* const nxt = acc->sib;
+                acc->sib = nullptr;
+                ret = meld(ret, acc);
+                acc = nxt;
+            }
+            return ret;
+        }
+        void deleteAll(Node* pos) { // rotate the first child up until there is none, O(1) extra space. the pool keeps the memory.
+            while(pos) {
+                if(pos->child) {
+                    Node* const c = pos->child;
+                    pos->child = c->sib, c->sib = pos, pos = c;
+                } else {
+                    Node* const nxt = pos->sib;
+                    pos->~Node();
+                    pos = nxt;
+                }
+            }
+        }
+        Node* copy(const Node* s) { // walk s in preorder through prv, building the same shape.
+            if(s == nullptr) return nullptr;
+            Node *ret = newNode(s->val), *d = ret;
+            SJTU_TRY {
+                while(1) {
+                    if(s->child) { d->child = newNode(s->child->val), d->child->prv = d, s = s->child, d = d->child; continue; }
+                    while(s->sib == nullptr) { // climb until we come up from a first child whose parent has a next sibling.
+                        const Node* p = s->prv;
+                        while(p && p->child != s) s = p, d = d->prv, p = s->prv; // back over the earlier siblings.
+                        if(p == nullptr) return ret;
+                        s = p, d = d->prv;
+                    }
+                    d->sib = newNode(s->sib->val), d->sib->prv = d, s = s->sib, d = d->sib;
+                }
+            } SJTU_CATCH_ALL {
+                deleteAll(ret);
+                SJTU_RETHROW;
+            }
+        }
+        void cut(Node* pos) { // take the subtree of pos, not the root, out of its sibling list.
+            (pos->prv->child == pos ? pos->prv->child : pos->prv->sib) = pos->sib;
+            if(pos->sib) pos->sib->prv = pos->prv;
+            pos->sib = pos->prv = nullptr;
+        }
+        Node* detach(Node* pos) { // take pos out, its children stay in the heap.
+            Node* const rest = combine(pos->child);
+            pos->child = nullptr;
+            if(pos == root) root = rest;
+            else cut(pos), root = meld(root, rest);
+            return pos;
+        }
+        template<class Visit>
+        void best(size_t k, Visit visit) { // the k best in order. the children of each are combined first, as pop does,
+            // so the next one is always the only child; elements and handles stay where they are.
+            for(Node* x = root; k && x; k--) {
+                if(x->child && x->child->sib) {
+                    Node* const c = combine(x->child);
+                    x->child = c, c->prv = x;
+                }
+                Node* const nxt = x->child;
+                visit(x);
+                x = nxt;
+            }
+        }
+        Node* check(const handle &h) const { if(h.nd == nullptr) SJTU_THROW(invalid_iterator()); return h.nd; }
+    public:
+        class handle { // stays valid until its element is popped or erased.
+            friend class pairing_heap;
+            Node* nd;
+            explicit handle(Node* _nd): nd(_nd) {}
+        public:
+            handle(): nd(nullptr) {}
+            const T & operator*() const { return nd->val; }
+            const T* operator->() const { return &nd->val; }
+            bool operator==(const handle &rhs) const { return nd == rhs.nd; }
+            bool operator!=(const handle &rhs) const { return nd != rhs.nd; }
+        };
+
+        pairing_heap(): root(nullptr), _size(0) {}
+        explicit pairing_heap(const Compare &_comp): root(nullptr), comp(_comp), _size(0) {}
+        pairing_heap(const pairing_heap &other): comp(other.comp), _size(other._size) { root = copy(other.root); }
+        ~pairing_heap() { deleteAll(root); }
+        template<class InputIterator>
+        pairing_heap(InputIterator first, InputIterator last, const Compare &_comp = Compare()): root(nullptr), comp(_comp), _size(0) { push_range(first, last); }
+        pairing_heap(pairing_heap &&other): root(nullptr), comp(other.comp), _size(0) { swap(other); } // O(1), other becomes empty.
+        pairing_heap &operator=(const pairing_heap &other) {
+            if(this == &other) return *this;
+            pairing_heap tmp(other);
+            swap(tmp);
+            return *this;
+        }
+        pairing_heap &operator=(pairing_heap &&other) {
+            if(this == &other) return *this;
+            pairing_heap tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+        void swap(pairing_heap &other) { std::swap(root, other.root), std::swap(comp, other.comp), std::swap(_size, other._size), pool.swap(other.pool); }
+
+        const T & top() const {
+            if(root == nullptr) SJTU_THROW(container_is_empty());
+            return root->val;
+        }
+        handle push(const T &e) { return emplace(e); }
+        handle push(T &&e) { return emplace(std::move(e)); }
+        template<class... Args>
+        handle emplace(Args&&... args) { // the node is reused from the pool when one was popped before.
+            Node* const nv = newNode(std::forward<Args>(args)...);
+            root = meld(root, nv), ++_size;
+            return handle(nv);
+        }
+        void pop() {
+            if(root == nullptr) SJTU_THROW(container_is_empty());
+            Node* const mem = root;
+            root = combine(root->child), --_size;
+            deleteNode(mem);
+        }
+        template<class InputIterator>
+        void push_range(InputIterator first, InputIterator last) { // the new nodes as one sibling list, then a single combine: O(k).
+            Node *head = nullptr, *tail = nullptr;
+            size_t cnt = 0;
+            SJTU_TRY {
+                for(; first != last; ++first, ++cnt) {
+                    Node* const nv = newNode(*first);
+                    if(tail) tail->sib = nv, nv->prv = tail;
+                    else head = nv;
+                    tail = nv;
+                }
+            } SJTU_CATCH_ALL {
+                while(head) { Node* const nxt = head->sib; deleteNode(head), head = nxt; }
+                SJTU_RETHROW;
+            }
+            root = meld(root, combine(head)), _size += cnt;
+        }
+        void pop(T &out) { // move the top into out, then pop it.
+            if(root == nullptr) SJTU_THROW(container_is_empty());
+            out = std::move(root->val);
+            pop();
+        }
+        template<class OutputIterator>
+        // copy the k best, best first: O(k log n) amortized, a second call is O(k). not const: the child lists on the
+        // way are combined as pop would, a read-only walk would have to scan every child of the root.
+        OutputIterator top_k(size_t k, OutputIterator out) {
+            best(k, [&](Node* x) { *out++ = x->val; });
+            return out;
+        }
+        template<class OutputIterator>
+        OutputIterator pop_k(size_t k, OutputIterator out) { // move the k best out, best first: k pops.
+            for(; k && root; k--) *out++ = std::move(root->val), pop();
+            return out;
+        }
+
+        // the element of h moves towards the top: cut its subtree out and meld it with the root, O(1) amortized.
+        void decrease_key(const handle &h, const T &e) {
+            Node* const pos = check(h);
+            if(comp(e, pos->val)) { pos->val = e, update(h); return; } // it got worse after all.
+            pos->val = e;
+            if(pos != root) cut(pos), root = meld(root, pos);
+        }
+        void update(const handle &h, const T &e) { check(h)->val = e, update(h); }
+        void update(const handle &h) { root = meld(root, detach(check(h))); } // the priority of *h changed in any direction.
+        void erase(const handle &h) { deleteNode(detach(check(h))), --_size; }
+
+        size_t size() const { return _size; }
+        bool empty() const { return root == nullptr; }
+
+        void merge(pairing_heap &other) { // O(1), other becomes empty.
+            if(this == &other) return;
+            root = meld(root, other.root), _size += other._size, pool.splice(other.pool);
+            other.root = nullptr, other._size = 0;
+        }
+    };
+
+}
+
+#endif
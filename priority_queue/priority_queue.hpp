@@ -4,6 +4,10 @@
 #include <cstddef>
 #include <functional>
 #include "exceptions.hpp"
+#include "leftist_heap.hpp"
+#include "pairing_heap.hpp"
+#include "dary_heap.hpp"
+#include "monotone_priority_queue.hpp"
 
 /*#include <iostream>
 #define debug cout
@@ -12,91 +16,39 @@ using namespace std;*/
 namespace sjtu {
 
 /**
- * a container like std::priority_queue which is a heap internal.
+ * the heap under priority_queue.
+ * leftist_policy: nodes, O(log n) push, pop and merge.
+ * pairing_policy: nodes, O(1) push and merge, O(log n) amortized pop.
+ * dary_policy<D>: one array, no allocation per element and the fastest push and pop, but merge is O(n).
+ * with the two node policies push returns a handle, for decrease_key, update and erase of that element.
+ * every policy has top_k, the k best read without popping them, and pop_k. the pairing heap's top_k is not const,
+ * it restructures the heap the way pop does.
+ * for unsigned keys that are popped in increasing order, monotone_priority_queue is a radix heap with the same interface.
  */
 
-    template<typename T, class Compare = std::less<T> >
-    class priority_queue {
-    private:
-        struct Node {
-            T val;
-            Node *ls, *rs;
-            int dis;
-            Node(const T &_val): val(_val), ls(nullptr), rs(nullptr), dis(0) {}
-            void maintain() {
-                if(ls == nullptr || (rs != nullptr && ls->dis < rs->dis)) std::swap(ls, rs);
-                dis = (rs == nullptr ? -1 : rs->dis) + 1;
-            }
-        }*root;
-
-        inline void deleteAll(Node* pos) {
-            if(pos == nullptr) return;
-            deleteAll(pos->ls), deleteAll(pos->rs);
-            delete pos;
-        }
-        inline Node* copy(const Node* x) {
-            if(x == nullptr) return nullptr;
-            Node* ret = new Node(x->val);
-            ret->ls = copy(x->ls);
-            ret->rs = copy(x->rs);
-            ret->maintain();
-            return ret;
-        }
-        inline Node* merge(Node* a, Node* b) {
-            if(a == nullptr || b == nullptr) return b == nullptr ? a : b;
-            if(Compare()(a->val, b->val)) std::swap(a, b);
-            a->rs = merge(a->rs, b);
-            a->maintain();
-            return a;
-        }
-        size_t _size;
-    public:
-        priority_queue(): _size(0) {
-            root = nullptr;
-        }
-        priority_queue(const priority_queue &other): _size(other._size) {
-            root = copy(other.root);
-        }
-        ~priority_queue() {
-            deleteAll(root);
-        }
-        priority_queue &operator=(const priority_queue &other) {
-            if(this == &other) return *this;
-            deleteAll(root);
-            root = copy(other.root);
-            _size = other._size;
-            return *this;
-        }
-
-        const T & top() const {
-            if(root == nullptr) throw container_is_empty();
-            return root->val;
-        }
+    struct leftist_policy {
+        template<typename T, class Compare> using heap = leftist_heap<T, Compare>;
+    };
+    struct pairing_policy {
+        template<typename T, class Compare> using heap = pairing_heap<T, Compare>;
+    };
+    template<int D = 4>
+    struct dary_policy {
+        template<typename T, class Compare> using heap = dary_heap<T, Compare, D>;
+    };
 
-        void push(const T &e) {
-            ++_size;
-            Node* nv = new Node(e);
-            root = merge(nv, root);
-        }
-        void pop() {
-            if(root == nullptr) throw container_is_empty();
-            --_size;
-            Node* mem = root;
-            root = merge(root->ls, root->rs);
-            delete  mem;
-        }
-        size_t size() const {
-            return _size;
-        }
-        bool empty() const {
-            return root == nullptr;
-        }
+/**
+ * a container like std::priority_queue which is a heap internal.
+ */
 
-        void merge(priority_queue &other) {
-            _size += other._size;
-            root = merge(root, other.root);
-            other.root = nullptr, other._size = 0;
-        }
+    template<typename T, class Compare = std::less<T>, class Policy = leftist_policy>
+    class priority_queue : public Policy::template heap<T, Compare> {
+        typedef typename Policy::template heap<T, Compare> heap;
+    public:
+        priority_queue() {}
+        explicit priority_queue(const Compare &_comp): heap(_comp) {}
+        template<class InputIterator>
+        priority_queue(InputIterator first, InputIterator last, const Compare &_comp = Compare()): heap(first, last, _comp) {} // O(n)
     };
 
 }
@@ -0,0 +1,115 @@
+/**
+ * compares the heap policies of priority_queue on int keys.
+ * usage: priority_queue_bench [n]
+ * push-heavy: three pushes per pop, n pushes in all.
+ * pop-heavy: n pushes, then pops until empty.
+ * merge-heavy: n / 16 queues of 16 elements merged into one, then a pop after every merge.
+ * batches: a queue of n elements gives up its best k and gets k new ones, n / k times,
+ * once by k pops and once by pop_k; top_k only reads the best k, n / k times.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <iterator>
+#include <queue>
+#include <vector>
+#include "priority_queue.hpp"
+
+namespace {
+
+unsigned seed = 2333;
+unsigned rnd() { seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5; return seed; }
+
+template<class F>
+double timed(F f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+long long sink; // printed at the end, so the work is not optimized away.
+
+template<class Q>
+double pushHeavy(int n) {
+    seed = 2333;
+    return timed([&] {
+        Q q;
+        for(int i = 0; i < n; i++) {
+            q.push(int(rnd()));
+            if(i % 3 == 2) sink += q.top(), q.pop();
+        }
+        sink += q.size();
+    });
+}
+template<class Q>
+double popHeavy(int n) {
+    seed = 2333;
+    return timed([&] {
+        Q q;
+        for(int i = 0; i < n; i++) q.push(int(rnd()));
+        while(!q.empty()) sink += q.top(), q.pop();
+    });
+}
+template<class Q>
+double mergeHeavy(int n) {
+    seed = 2333;
+    return timed([&] {
+        Q all;
+        for(int i = 0; i < n / 16; i++) {
+            Q part;
+            for(int j = 0; j < 16; j++) part.push(int(rnd()));
+            all.merge(part);
+            sink += all.top(), all.pop();
+        }
+        sink += all.size();
+    });
+}
+struct std_queue : std::priority_queue<int> { // the baseline, merge pushes every element over.
+    void merge(std_queue &other) { while(!other.empty()) push(other.top()), other.pop(); }
+};
+
+template<class Q>
+void row(const char* name, int n) { printf("%-16s %12.1f %12.1f %12.1f\n", name, pushHeavy<Q>(n), popHeavy<Q>(n), mergeHeavy<Q>(n)); }
+
+enum Batch { POPS, POP_K, TOP_K };
+template<class Q>
+double batches(int n, size_t k, Batch how) {
+    seed = 2333;
+    Q q;
+    for(int i = 0; i < n; i++) q.push(int(rnd()));
+    std::vector<int> got;
+    got.reserve(k);
+    return timed([&] {
+        for(size_t r = n / k; r; r--) {
+            got.clear();
+            if(how == POPS) for(size_t i = 0; i < k; i++) got.push_back(q.top()), q.pop();
+            else if(how == POP_K) q.pop_k(k, std::back_inserter(got));
+            else q.top_k(k, std::back_inserter(got));
+            sink += got.back();
+            if(how != TOP_K) for(size_t i = 0; i < k; i++) q.push(int(rnd()));
+        }
+    });
+}
+template<class Q>
+void batchRows(const char* name, int n) {
+    for(size_t k = 1; k <= 10000; k *= 10)
+        printf("%-16s %6zu %12.1f %12.1f %12.1f\n", name, k, batches<Q>(n, k, POPS), batches<Q>(n, k, POP_K), batches<Q>(n, k, TOP_K));
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    printf("n = %d, milliseconds\n%-16s %12s %12s %12s\n", n, "policy", "push-heavy", "pop-heavy", "merge-heavy");
+    row<sjtu::priority_queue<int, std::less<int>, sjtu::leftist_policy> >("leftist", n);
+    row<sjtu::priority_queue<int, std::less<int>, sjtu::pairing_policy> >("pairing", n);
+    row<sjtu::priority_queue<int, std::less<int>, sjtu::dary_policy<2> > >("dary<2>", n);
+    row<sjtu::priority_queue<int, std::less<int>, sjtu::dary_policy<4> > >("dary<4>", n);
+    row<std_queue>("std", n);
+    printf("\nbatches of k, milliseconds\n%-16s %6s %12s %12s %12s\n", "policy", "k", "k pops", "pop_k", "top_k");
+    batchRows<sjtu::priority_queue<int, std::less<int>, sjtu::leftist_policy> >("leftist", n);
+    batchRows<sjtu::priority_queue<int, std::less<int>, sjtu::pairing_policy> >("pairing", n);
+    batchRows<sjtu::priority_queue<int, std::less<int>, sjtu::dary_policy<4> > >("dary<4>", n);
+    printf("checksum %lld\n", sink);
+    return 0;
+}
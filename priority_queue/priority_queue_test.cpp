@@ -0,0 +1,220 @@
+/**
+ * every heap policy of priority_queue against std::multiset, then the handles of the node policies,
+ * then monotone_priority_queue.
+ * usage: priority_queue_test [operations] [seed]
+ * prints the first mismatch and exits with 1, otherwise prints ok.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+#include "priority_queue.hpp"
+
+namespace {
+
+typedef std::multiset<int> Ref;
+
+int failures = 0;
+#define EXPECT(cond) do { if(!(cond)) { printf("line %d, step %ld: %s\n", __LINE__, step, #cond); ++failures; return; } } while(0)
+
+template<class Q>
+void drained(Q q, const Ref &ref, long step) { // a copy popped until empty gives ref from the largest down.
+    EXPECT(q.size() == ref.size() && q.empty() == ref.empty());
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) {
+        EXPECT(q.top() == *r);
+        q.pop();
+    }
+    bool thrown = false;
+    try { q.pop(); } catch(sjtu::container_is_empty &) { thrown = true; }
+    EXPECT(thrown && q.empty());
+}
+
+template<class Q>
+void fuzz(long n, unsigned seed, int range) {
+    Q q;
+    Ref ref;
+    std::vector<int> got;
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 10;
+        if(op <= 1) {
+            if(op == 1) q.emplace(key);
+            else q.push(key);
+            ref.insert(key);
+        } else if(op >= 2 && op <= 4) {
+            bool thrown = false;
+            try {
+                int out = -1;
+                if(op == 4) q.pop(out);
+                else out = q.top(), q.pop();
+                EXPECT(out == *ref.rbegin());
+            } catch(sjtu::container_is_empty &) { thrown = true; }
+            EXPECT(thrown == ref.empty());
+            if(!thrown) ref.erase(std::prev(ref.end()));
+        } else if(op == 5) { // a range at once, through the O(n) build or push_range.
+            std::vector<int> more;
+            for(int i = int(seed >> 8) % 16; i; i--) more.push_back(int((seed = seed * 1103515245 + 12345) % range));
+            if(seed & 1) q.push_range(more.begin(), more.end());
+            else {
+                Q built(more.begin(), more.end());
+                q.merge(built);
+                EXPECT(built.empty() && built.size() == 0);
+            }
+            ref.insert(more.begin(), more.end());
+        } else if(op == 6) { // another queue merged in, or itself.
+            Q other;
+            for(int i = int(seed >> 8) % 8; i; i--) other.push(key + i), ref.insert(key + i);
+            q.merge(other), q.merge(q);
+            EXPECT(other.empty());
+        } else if(op == 7 || op == 8) { // the best k, read or taken.
+            const size_t k = (seed >> 8) % 12;
+            got.clear();
+            if(op == 7) q.top_k(k, std::back_inserter(got));
+            else q.pop_k(k, std::back_inserter(got));
+            EXPECT(got.size() == (k < ref.size() ? k : ref.size()));
+            auto r = ref.rbegin();
+            for(size_t i = 0; i < got.size(); i++, ++r) EXPECT(got[i] == *r);
+            if(op == 8) for(size_t i = 0; i < got.size(); i++) ref.erase(std::prev(ref.end()));
+        } else EXPECT(q.size() == ref.size() && q.empty() == ref.empty());
+        if(step % 16384 == 0) { // copies, moves and swaps stay apart from the original.
+            Q copy(q), assigned, moved;
+            assigned = q, copy.push(range), copy.pop();
+            drained(assigned, ref, step);
+            moved = std::move(assigned);
+            EXPECT(assigned.empty());
+            drained(moved, ref, step);
+            Q other;
+            other.swap(q), drained(other, ref, step), drained(q, Ref(), step), q.swap(other);
+        } else if(step % 4096 == 0) drained(q, ref, step);
+        if(failures) return;
+    }
+    drained(q, ref, n);
+}
+
+typedef std::pair<int, int> Item; // priority, then a unique id.
+typedef std::set<Item> Items;
+
+template<class Q>
+void handles(long n, unsigned seed, int range) { // decrease_key, update and erase through the handles push returned.
+    Q q;
+    Items ref;
+    std::vector<typename Q::handle> h;
+    std::vector<Item> val; // what h[i] points to now,
+    std::vector<char> live; // while it is in q.
+    for(long step = 0; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const int key = int(seed % range), op = (seed >> 24) % 8;
+        const size_t i = val.empty() ? 0 : (seed >> 8) % val.size();
+        if(op <= 2) {
+            const Item x(key, int(val.size()));
+            h.push_back(q.push(x)), val.push_back(x), live.push_back(1), ref.insert(x);
+            EXPECT(*h.back() == x);
+        } else if(op == 3) {
+            if(ref.empty()) continue;
+            const Item x = q.top();
+            EXPECT(x == *ref.rbegin());
+            q.pop(), ref.erase(x), live[x.second] = 0;
+        } else if(val.empty() || !live[i]) continue;
+        else if(op == 4) { // better, or sometimes worse after all.
+            const Item x(seed & 1 ? val[i].first + key % 1000 : val[i].first - key % 100, int(i));
+            q.decrease_key(h[i], x), ref.erase(val[i]), ref.insert(x), val[i] = x;
+        } else if(op == 5) {
+            const Item x(key, int(i));
+            q.update(h[i], x), ref.erase(val[i]), ref.insert(x), val[i] = x;
+        } else q.erase(h[i]), ref.erase(val[i]), live[i] = 0;
+        EXPECT(q.size() == ref.size() && (ref.empty() || q.top() == *ref.rbegin()));
+        if(step % 4096 == 0) for(size_t j = 0; j < val.size(); j++) if(live[j]) EXPECT(*h[j] == val[j]);
+        if(failures) return;
+    }
+    bool thrown = false;
+    try { q.erase(typename Q::handle()); } catch(sjtu::invalid_iterator &) { thrown = true; }
+    long step = n;
+    EXPECT(thrown);
+    for(auto r = ref.rbegin(); r != ref.rend(); ++r) {
+        EXPECT(q.top() == *r);
+        q.pop();
+    }
+    EXPECT(q.empty());
+}
+
+struct Event { // a key and a payload, popped by the key.
+    unsigned long long time;
+    std::string name;
+};
+struct TimeOf {
+    unsigned long long operator()(const Event &e) const { return e.time; }
+};
+
+template<class Key>
+void monotone(long n, unsigned seed, unsigned long long spread) { // pushes never below the last key popped.
+    long step = 0;
+    sjtu::monotone_priority_queue<Key> q;
+    std::multiset<Key> ref;
+    Key last = 0;
+    for(; step < n; step++) {
+        seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+        const Key key = Key(last + Key(((unsigned long long)seed << 20 ^ seed) % spread));
+        if((seed >> 24) % 5 < 3 && key >= last) q.push(key), ref.insert(key);
+        else if(!ref.empty()) {
+            EXPECT(q.top() == *ref.begin());
+            Key out;
+            q.pop(out), last = out, ref.erase(ref.begin());
+        }
+        EXPECT(q.size() == ref.size());
+        if(step % 4096 == 0 && last > 0) {
+            bool thrown = false;
+            try { q.push(last - 1); } catch(sjtu::runtime_error &) { thrown = true; }
+            EXPECT(thrown && q.size() == ref.size());
+            sjtu::monotone_priority_queue<Key> copy(q);
+            for(auto it = ref.begin(); it != ref.end(); ++it) {
+                EXPECT(copy.top() == *it);
+                copy.pop();
+            }
+        }
+        if(failures) return;
+    }
+    for(auto it = ref.begin(); it != ref.end(); ++it) {
+        EXPECT(q.top() == *it);
+        q.pop();
+    }
+    bool thrown = false;
+    try { q.top(); } catch(sjtu::container_is_empty &) { thrown = true; }
+    EXPECT(thrown);
+}
+
+void events() { // elements keyed by KeyOf keep their payload.
+    long step = 0;
+    sjtu::monotone_priority_queue<Event, TimeOf> q;
+    for(int i = 99; i >= 0; i--) q.push(Event{(unsigned long long)(i / 2) << 40, std::to_string(i)});
+    for(int i = 0; i < 100; i++, step++) {
+        Event e;
+        q.pop(e);
+        EXPECT(e.time == (unsigned long long)(i / 2) << 40 && std::atoi(e.name.c_str()) / 2 == i / 2);
+    }
+    EXPECT(q.empty());
+}
+
+}
+
+int main(int argc, char** argv) {
+    const long n = argc > 1 ? atol(argv[1]) : 100000;
+    const unsigned seed = argc > 2 ? unsigned(atol(argv[2])) : 2333;
+    for(int range : {16, 1 << 30}) {
+        fuzz<sjtu::priority_queue<int, std::less<int>, sjtu::leftist_policy> >(n, seed + range, range);
+        fuzz<sjtu::priority_queue<int, std::less<int>, sjtu::pairing_policy> >(n, seed + range, range);
+        fuzz<sjtu::priority_queue<int, std::less<int>, sjtu::dary_policy<2> > >(n, seed + range, range);
+        fuzz<sjtu::priority_queue<int, std::less<int>, sjtu::dary_policy<4> > >(n, seed + range, range);
+        fuzz<sjtu::priority_queue<int, std::less<int>, sjtu::dary_policy<7> > >(n, seed + range, range);
+        handles<sjtu::priority_queue<Item, std::less<Item>, sjtu::leftist_policy> >(n, seed + range, range);
+        handles<sjtu::priority_queue<Item, std::less<Item>, sjtu::pairing_policy> >(n, seed + range, range);
+    }
+    monotone<unsigned char>(n, seed, 8);
+    monotone<unsigned>(n, seed, 1000);
+    monotone<unsigned long long>(n, seed, 1ull << 62);
+    events();
+    if(failures) return 1;
+    printf("ok\n");
+    return 0;
+}